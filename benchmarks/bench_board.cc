@@ -0,0 +1,207 @@
+#include <benchmark/benchmark.h>
+
+#include "xiangqi/bitboard_c.h"
+#include "xiangqi/board.h"
+#include "xiangqi/board_c.h"
+
+namespace {
+
+using ::xq::Board;
+using ::xq::BoardEq;
+using ::xq::BoardFromString;
+using ::xq::kStartingBoard;
+
+static void BM_FindGeneral_C(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        FindGeneral_C(kStartingBoard.data(), PLAYER_RED) +
+        FindGeneral_C(kStartingBoard.data(), PLAYER_BLACK));
+  }
+}
+
+static void BM_FlipBoard_C(benchmark::State& state) {
+  const Board src = kStartingBoard;
+  Board dest;
+  for (auto _ : state) {
+    FlipBoard_C(dest.data(), src.data());
+    benchmark::ClobberMemory();
+  }
+}
+
+static void BM_MirrorBoardHorizontal_C(benchmark::State& state) {
+  const Board src = kStartingBoard;
+  Board dest;
+  for (auto _ : state) {
+    MirrorBoardHorizontal_C(dest.data(), src.data());
+    benchmark::ClobberMemory();
+  }
+}
+
+static void BM_MirrorBoardVertical_C(benchmark::State& state) {
+  const Board src = kStartingBoard;
+  Board dest;
+  for (auto _ : state) {
+    MirrorBoardVertical_C(dest.data(), src.data());
+    benchmark::ClobberMemory();
+  }
+}
+
+static void BM_BoardEq(benchmark::State& state) {
+  const Board a = kStartingBoard;
+  Board b = kStartingBoard;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(b);
+    benchmark::DoNotOptimize(BoardEq(a, b));
+  }
+}
+
+static void BM_IsBeingCheckmate_C(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        IsBeingCheckmate_C(kStartingBoard.data(), PLAYER_RED));
+  }
+}
+
+static void BM_IsSquareAttacked_C(benchmark::State& state) {
+  for (auto _ : state) {
+    for (Position pos = 0; pos < K_BOARD_SIZE; pos++) {
+      benchmark::DoNotOptimize(
+          IsSquareAttacked_C(kStartingBoard.data(), pos, PLAYER_RED));
+    }
+  }
+}
+
+static void BM_ComputeAttackMap_C(benchmark::State& state) {
+  AttackMapC attacks;
+  for (auto _ : state) {
+    ComputeAttackMap_C(kStartingBoard.data(), PLAYER_RED, attacks);
+    benchmark::DoNotOptimize(attacks);
+  }
+}
+
+// Checks every move from the starting board.
+static void BM_MoveGivesCheck_C(benchmark::State& state) {
+  MaxMovesPerPlayerC moves;
+  const uint8_t num_moves =
+      PossibleMoves_C(kStartingBoard.data(), PLAYER_RED, false, moves);
+  for (auto _ : state) {
+    GivesCheckInfoC info;
+    ComputeGivesCheckInfo_C(kStartingBoard.data(), PLAYER_RED, &info);
+    for (uint8_t i = 0; i < num_moves; i++) {
+      benchmark::DoNotOptimize(
+          MoveGivesCheck_C(kStartingBoard.data(), &info, moves[i]));
+    }
+  }
+}
+
+// Same as BM_MoveGivesCheck_C, by copying the board and making the move.
+static void BM_MoveGivesCheck_CopyAndScan(benchmark::State& state) {
+  MaxMovesPerPlayerC moves;
+  const uint8_t num_moves =
+      PossibleMoves_C(kStartingBoard.data(), PLAYER_RED, false, moves);
+  for (auto _ : state) {
+    for (uint8_t i = 0; i < num_moves; i++) {
+      Board board = kStartingBoard;
+      Move_C(board.data(), moves[i]);
+      benchmark::DoNotOptimize(IsBeingCheckmate_C(board.data(), PLAYER_BLACK));
+    }
+  }
+}
+
+// Evaluates the capture sequence on E3 from the x-ray test.
+static void BM_StaticExchangeEval_C(benchmark::State& state) {
+  const Board board = BoardFromString(
+      "  A B C D E F G H I \n"
+      "0 . . . g * * . . . \n"
+      "1 . . . * r * . . . \n"
+      "2 . . . * * * . . . \n"
+      "3 . . . . h . . . . \n"
+      "4 - - - - - - - - - \n"
+      "5 - - - - R - - - - \n"
+      "6 . . . . . . . . . \n"
+      "7 . . . * H * . . . \n"
+      "8 . . . * * * . . . \n"
+      "9 . . . * C G . . . \n");
+  const Movement movement = NewMovement(PosStr("E5"), PosStr("E3"));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(StaticExchangeEval_C(board.data(), movement));
+  }
+}
+
+static void BM_EncodeBoardState_C(benchmark::State& state) {
+  BoardStateC encoded;
+  for (auto _ : state) {
+    EncodeBoardState_C(kStartingBoard.data(), encoded);
+    benchmark::DoNotOptimize(encoded);
+  }
+}
+
+static void BM_DecodeBoardState_C(benchmark::State& state) {
+  BoardStateC encoded;
+  EncodeBoardState_C(kStartingBoard.data(), encoded);
+  Board board;
+  for (auto _ : state) {
+    DecodeBoardState_C(encoded, board.data());
+    benchmark::DoNotOptimize(board);
+  }
+}
+
+// A capture and its undo.
+static void BM_BoardStateMove_C(benchmark::State& state) {
+  BoardStateC encoded;
+  EncodeBoardState_C(kStartingBoard.data(), encoded);
+  const Movement movement = NewMovement(PosStr("B7"), PosStr("B0"));
+  for (auto _ : state) {
+    BoardStateMove_C(encoded, R_CANNON, B_HORSE, movement);
+    BoardStateUnmove_C(encoded, R_CANNON, B_HORSE, movement);
+    benchmark::DoNotOptimize(encoded);
+  }
+}
+
+static void BM_BoardToFen_C(benchmark::State& state) {
+  char fen[K_FEN_STR_SIZE];
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        BoardToFen_C(kStartingBoard.data(), PLAYER_RED, fen));
+    benchmark::ClobberMemory();
+  }
+}
+
+static void BM_BoardFromFen_C(benchmark::State& state) {
+  char fen[K_FEN_STR_SIZE];
+  const uint8_t size = BoardToFen_C(kStartingBoard.data(), PLAYER_RED, fen);
+  Board board;
+  enum Player player;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(BoardFromFen_C(fen, size, board.data(), &player));
+    benchmark::DoNotOptimize(board);
+  }
+}
+
+static void BM_BoardToBitboards_C(benchmark::State& state) {
+  BitboardsC bitboards;
+  for (auto _ : state) {
+    BoardToBitboards_C(kStartingBoard.data(), &bitboards);
+    benchmark::DoNotOptimize(bitboards);
+  }
+}
+
+BENCHMARK(BM_FindGeneral_C);
+BENCHMARK(BM_FlipBoard_C);
+BENCHMARK(BM_MirrorBoardHorizontal_C);
+BENCHMARK(BM_MirrorBoardVertical_C);
+BENCHMARK(BM_BoardEq);
+BENCHMARK(BM_IsBeingCheckmate_C);
+BENCHMARK(BM_IsSquareAttacked_C);
+BENCHMARK(BM_ComputeAttackMap_C);
+BENCHMARK(BM_MoveGivesCheck_C);
+BENCHMARK(BM_MoveGivesCheck_CopyAndScan);
+BENCHMARK(BM_StaticExchangeEval_C);
+BENCHMARK(BM_EncodeBoardState_C);
+BENCHMARK(BM_DecodeBoardState_C);
+BENCHMARK(BM_BoardStateMove_C);
+BENCHMARK(BM_BoardToFen_C);
+BENCHMARK(BM_BoardFromFen_C);
+BENCHMARK(BM_BoardToBitboards_C);
+
+}  // namespace
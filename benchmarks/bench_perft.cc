@@ -0,0 +1,95 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+#include "xiangqi/board.h"
+#include "xiangqi/perft.h"
+#include "xiangqi/perft_c.h"
+#include "xiangqi/tracked_board_c.h"
+
+namespace {
+
+using ::xq::Board;
+using ::xq::BoardFromString;
+using ::xq::kStartingBoard;
+
+const Board kMidgameBoard = BoardFromString(
+    "  A B C D E F G H I \n"
+    "0 r . e a g a e . . \n"
+    "1 . . . * * * . . r \n"
+    "2 . c h * * * . c . \n"
+    "3 s . s . s . . . s \n"
+    "4 - - - - - - s - - \n"
+    "5 - - S - - - - - - \n"
+    "6 S . . . S . S h S \n"
+    "7 . C H * * * . C . \n"
+    "8 . . . * * * . . . \n"
+    "9 R . E A G A E H R \n");
+
+// Reports leaf nodes per second of a perft of depth state.range(0).
+void RunPerft(benchmark::State& state, const Board& board) {
+  const uint8_t depth = static_cast<uint8_t>(state.range(0));
+  uint64_t nodes = 0;
+  for (auto _ : state) {
+    nodes += Perft_C(board.data(), PLAYER_RED, depth);
+  }
+  state.counters["nodes"] = benchmark::Counter(
+      static_cast<double>(nodes), benchmark::Counter::kIsRate);
+}
+
+void RunTrackedPerft(benchmark::State& state, const Board& board) {
+  const uint8_t depth = static_cast<uint8_t>(state.range(0));
+  TrackedBoardC tracked;
+  TrackBoard_C(board.data(), &tracked);
+  uint64_t nodes = 0;
+  for (auto _ : state) {
+    nodes += TrackedPerft_C(&tracked, PLAYER_RED, depth);
+  }
+  state.counters["nodes"] = benchmark::Counter(
+      static_cast<double>(nodes), benchmark::Counter::kIsRate);
+}
+
+// Perft of depth state.range(0) with state.range(1) threads, the cache is
+// created for every run so that results are not reused across iterations. It
+// is kept small, zeroing the default 64 MB would take longer than the perft.
+static void BM_ParallelPerft(benchmark::State& state) {
+  const uint8_t depth = static_cast<uint8_t>(state.range(0));
+  const unsigned num_threads = static_cast<unsigned>(state.range(1));
+  constexpr size_t kHashSizeMb = 4;
+  uint64_t nodes = 0;
+  for (auto _ : state) {
+    nodes += xq::ParallelPerft(kStartingBoard, PLAYER_RED, depth, num_threads,
+                               kHashSizeMb);
+  }
+  state.counters["nodes"] = benchmark::Counter(
+      static_cast<double>(nodes), benchmark::Counter::kIsRate);
+}
+
+static void BM_Perft_C(benchmark::State& state) {
+  RunPerft(state, kStartingBoard);
+}
+
+static void BM_Perft_C_Midgame(benchmark::State& state) {
+  RunPerft(state, kMidgameBoard);
+}
+
+static void BM_TrackedPerft_C(benchmark::State& state) {
+  RunTrackedPerft(state, kStartingBoard);
+}
+
+static void BM_TrackedPerft_C_Midgame(benchmark::State& state) {
+  RunTrackedPerft(state, kMidgameBoard);
+}
+
+BENCHMARK(BM_Perft_C)->DenseRange(2, 4)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Perft_C_Midgame)->DenseRange(2, 3)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ParallelPerft)
+    ->ArgsProduct({{3, 4}, {1, 2, 4}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_TrackedPerft_C)->DenseRange(2, 4)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TrackedPerft_C_Midgame)
+    ->DenseRange(2, 3)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -1,19 +1,53 @@
 #include <benchmark/benchmark.h>
 
 #include <array>
+#include <random>
+#include <vector>
 
 #include "xiangqi/board.h"
 #include "xiangqi/board_c.h"
+#include "xiangqi/tracked_board_c.h"
 
 namespace {
 
 namespace {
 
 using ::xq::Board;
+using ::xq::BatchPossibleBoards;
+using ::xq::BatchPossibleMoves;
+using ::xq::BoardFromString;
 using ::xq::kStartingBoard;
+using ::xq::MoveBatch;
 using ::xq::PossibleBoards;
 using ::xq::PossibleMoves;
 
+const Board kEndgameBoard = BoardFromString(
+    "  A B C D E F G H I \n"
+    "0 . . . a g * . . . \n"
+    "1 . . . * * * . . . \n"
+    "2 . . . * * * . . . \n"
+    "3 . . . . . . . . . \n"
+    "4 - - - - - r - - - \n"
+    "5 - - - - - - - - - \n"
+    "6 . . . . . . . . . \n"
+    "7 . . . * * * . . . \n"
+    "8 . . . * A * . . . \n"
+    "9 . . . * G * . . R \n");
+
+// Black is in check by the chariot on E5.
+const Board kCheckBoard = BoardFromString(
+    "  A B C D E F G H I \n"
+    "0 . . . a g * . . . \n"
+    "1 . . . * * * . . . \n"
+    "2 . . . * * * . . . \n"
+    "3 . . . . . . . . . \n"
+    "4 - - - - - - - - - \n"
+    "5 - - - - R - - - - \n"
+    "6 . . . . . . . . . \n"
+    "7 . . . * * * . . . \n"
+    "8 . . . * A * . . . \n"
+    "9 . . . * G * . . . \n");
+
 }  // namespace
 
 static void BM_PossibleMoves_C(benchmark::State& state) {
@@ -42,6 +76,84 @@ static void BM_PossibleMoves_AvoidCheckmate(benchmark::State& state) {
   }
 }
 
+static void BM_PossibleCaptures_C_AvoidCheckmate(benchmark::State& state) {
+  MaxMovesPerPlayerC out;
+  for (auto _ : state) {
+    PossibleCaptures_C(K_STARTING_BOARD, PLAYER_RED, true, out);
+  }
+}
+
+static void BM_TrackedPossibleMoves_C(benchmark::State& state) {
+  TrackedBoardC tracked;
+  TrackBoard_C(K_STARTING_BOARD, &tracked);
+  MaxMovesPerPlayerC out;
+  for (auto _ : state) {
+    TrackedPossibleMoves_C(&tracked, PLAYER_RED, false, out);
+  }
+}
+
+static void BM_TrackedPossibleMoves_C_AvoidCheckmate(benchmark::State& state) {
+  TrackedBoardC tracked;
+  TrackBoard_C(K_STARTING_BOARD, &tracked);
+  MaxMovesPerPlayerC out;
+  for (auto _ : state) {
+    TrackedPossibleMoves_C(&tracked, PLAYER_RED, true, out);
+  }
+}
+
+static void BM_PossibleMoves_C_Endgame(benchmark::State& state) {
+  MaxMovesPerPlayerC out;
+  for (auto _ : state) {
+    PossibleMoves_C(kEndgameBoard.data(), PLAYER_RED, true, out);
+  }
+}
+
+static void BM_TrackedPossibleMoves_C_Endgame(benchmark::State& state) {
+  TrackedBoardC tracked;
+  TrackBoard_C(kEndgameBoard.data(), &tracked);
+  MaxMovesPerPlayerC out;
+  for (auto _ : state) {
+    TrackedPossibleMoves_C(&tracked, PLAYER_RED, true, out);
+  }
+}
+
+static void BM_DidPlayerLose_C(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(DidPlayerLose_C(K_STARTING_BOARD, PLAYER_RED));
+  }
+}
+
+static void BM_DidPlayerLose_C_InCheck(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        DidPlayerLose_C(kCheckBoard.data(), PLAYER_BLACK));
+  }
+}
+
+// Every position of a random game, like the game over test of a playout.
+static void BM_DidPlayerLose_C_Playout(benchmark::State& state) {
+  std::vector<Board> boards;
+  std::vector<Player> players;
+  std::mt19937 rng(20250320);
+  Board board = kStartingBoard;
+  Player player = PLAYER_RED;
+  for (int ply = 0; ply < 200 && !DidPlayerLose_C(board.data(), player);
+       ply++) {
+    boards.push_back(board);
+    players.push_back(player);
+    const std::vector<Movement> moves = PossibleMoves(board, player, true);
+    std::uniform_int_distribution<size_t> dist(0, moves.size() - 1);
+    Move_C(board.data(), moves[dist(rng)]);
+    player = ChangePlayer(player);
+  }
+  for (auto _ : state) {
+    for (size_t i = 0; i < boards.size(); i++) {
+      benchmark::DoNotOptimize(DidPlayerLose_C(boards[i].data(), players[i]));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * boards.size());
+}
+
 static void BM_PossibleBoards_C(benchmark::State& state) {
   std::array<Piece, K_BOARD_SIZE * K_MAX_MOVE_PER_PLAYER> out;
   for (auto _ : state) {
@@ -68,15 +180,71 @@ static void BM_PossibleBoards_AvoidCheckmate(benchmark::State& state) {
   }
 }
 
+static void BM_ChildBoards_AvoidCheckmate(benchmark::State& state) {
+  for (auto _ : state) {
+    for (const Board& child :
+         xq::ChildBoards(kStartingBoard, PLAYER_RED, true)) {
+      benchmark::DoNotOptimize(child);
+    }
+  }
+}
+
+// Visits only the first child, like a consumer that stops early.
+static void BM_ChildBoards_First(benchmark::State& state) {
+  for (auto _ : state) {
+    xq::ChildBoards children(kStartingBoard, PLAYER_RED, true);
+    benchmark::DoNotOptimize(*children.begin());
+  }
+}
+
+// Children of state.range(0) boards, one call per board.
+static void BM_PossibleBoards_Loop(benchmark::State& state) {
+  const std::vector<Board> boards(state.range(0), kStartingBoard);
+  for (auto _ : state) {
+    for (const Board& board : boards) {
+      benchmark::DoNotOptimize(PossibleBoards(board, PLAYER_RED, true));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Same as BM_PossibleBoards_Loop, with a single batch reused across runs.
+static void BM_BatchPossibleBoards(benchmark::State& state) {
+  const std::vector<Board> boards(state.range(0), kStartingBoard);
+  const std::vector<Player> players(boards.size(), PLAYER_RED);
+  MoveBatch batch;
+  std::vector<Board> children;
+  for (auto _ : state) {
+    BatchPossibleMoves(boards, players, true, batch);
+    BatchPossibleBoards(boards, batch, children);
+    benchmark::DoNotOptimize(children.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
 BENCHMARK(BM_PossibleMoves_C);
 BENCHMARK(BM_PossibleMoves_C_AvoidCheckmate);
 BENCHMARK(BM_PossibleMoves);
 BENCHMARK(BM_PossibleMoves_AvoidCheckmate);
 
+BENCHMARK(BM_PossibleCaptures_C_AvoidCheckmate);
+
+BENCHMARK(BM_TrackedPossibleMoves_C);
+BENCHMARK(BM_TrackedPossibleMoves_C_AvoidCheckmate);
+BENCHMARK(BM_PossibleMoves_C_Endgame);
+BENCHMARK(BM_TrackedPossibleMoves_C_Endgame);
+
+BENCHMARK(BM_DidPlayerLose_C);
+BENCHMARK(BM_DidPlayerLose_C_InCheck);
+BENCHMARK(BM_DidPlayerLose_C_Playout);
 BENCHMARK(BM_PossibleBoards_C);
 BENCHMARK(BM_PossibleBoards_C_AvoidCheckmate);
 BENCHMARK(BM_PossibleBoards);
 BENCHMARK(BM_PossibleBoards_AvoidCheckmate);
+BENCHMARK(BM_ChildBoards_AvoidCheckmate);
+BENCHMARK(BM_ChildBoards_First);
+BENCHMARK(BM_PossibleBoards_Loop)->Arg(1)->Arg(64)->Arg(1024);
+BENCHMARK(BM_BatchPossibleBoards)->Arg(1)->Arg(64)->Arg(1024);
 
 }  // namespace
 
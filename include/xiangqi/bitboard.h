@@ -0,0 +1,27 @@
+#ifndef XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_BITBOARD_H_
+#define XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_BITBOARD_H_
+
+#include <vector>
+
+#include "xiangqi/bitboard_c.h"
+#include "xiangqi/types.h"
+
+namespace xq {
+
+using Bitboard = BitboardC;
+
+using Bitboards = BitboardsC;
+
+// C++ wrapper of BoardToBitboards_C.
+Bitboards BoardToBitboards(const Board& board);
+
+// C++ wrapper of BitboardsToBoard_C.
+Board BitboardsToBoard(const Bitboards& bitboards);
+
+// C++ wrapper of BitboardPossibleMoves_C.
+std::vector<Movement> BitboardPossibleMoves(const Bitboards& bitboards,
+                                            Player player);
+
+}  // namespace xq
+
+#endif  // XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_BITBOARD_H_
@@ -0,0 +1,88 @@
+#ifndef XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_BITBOARD_C_H_
+#define XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_BITBOARD_C_H_
+
+#include "xiangqi/board_c.h"
+#include "xiangqi/types_c.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Set of positions on the board, bit i represents Position i. Only the lower
+// K_BOARD_SIZE bits are used.
+typedef unsigned __int128 BitboardC;
+
+#define K_EMPTY_BITBOARD ((BitboardC)0)
+
+// Number of distinct piece types, indexed by the absolute value of Piece.
+// Index 0 is unused.
+#define K_TOTAL_PIECE_TYPES 8
+
+// Bitboard representation of a board.
+//
+// Position of a piece is the intersection of its type mask and color mask,
+// e.g. red horses are types[R_HORSE] & colors[PLAYER_RED].
+typedef struct {
+  // Positions of each piece type regardless of color, indexed by |Piece|.
+  BitboardC types[K_TOTAL_PIECE_TYPES];
+  // Positions of all pieces of a player, indexed by Player.
+  BitboardC colors[2];
+  // Positions of all pieces on the board.
+  BitboardC occupancy;
+  // Occupancy of each file, bit i of files[col] is set if Pos(i, col) is
+  // occupied. Kept alongside occupancy so that file lookups in the slider
+  // tables do not need to gather bits across ranks.
+  uint16_t files[K_TOTAL_COL];
+} BitboardsC;
+
+static inline BitboardC BitboardOf(const Position pos) {
+  return ((BitboardC)1) << pos;
+}
+
+static inline bool BitboardHas(const BitboardC bitboard, const Position pos) {
+  return (bitboard >> pos) & 1;
+}
+
+static inline uint8_t BitboardCount(const BitboardC bitboard) {
+  return __builtin_popcountll((uint64_t)bitboard) +
+         __builtin_popcountll((uint64_t)(bitboard >> 64));
+}
+
+// Returns the lowest position in a non-empty bitboard.
+static inline Position BitboardFirst(const BitboardC bitboard) {
+  const uint64_t low = (uint64_t)bitboard;
+  return low != 0 ? __builtin_ctzll(low)
+                  : 64 + __builtin_ctzll((uint64_t)(bitboard >> 64));
+}
+
+// Removes and returns the lowest position in a non-empty bitboard.
+static inline Position BitboardPop(BitboardC* bitboard) {
+  const Position pos = BitboardFirst(*bitboard);
+  *bitboard &= *bitboard - 1;
+  return pos;
+}
+
+static inline BitboardC PlayerPieces(const BitboardsC* bitboards,
+                                     const enum Piece piece) {
+  return bitboards->types[piece > 0 ? piece : -piece] &
+         bitboards->colors[piece > 0 ? PLAYER_RED : PLAYER_BLACK];
+}
+
+// Converts a mailbox board to its bitboard representation.
+void BoardToBitboards_C(const BoardC board, BitboardsC* out);
+
+// Converts a bitboard representation back to a mailbox board.
+void BitboardsToBoard_C(const BitboardsC* bitboards, BoardC out);
+
+// Get all possible moves for player using the bitboard representation. Each
+// move is a 16-bit unsigned integer, representing "from" and "to" positions.
+// Produces the same set of moves as PossibleMoves_C without avoid_checkmate,
+// ordering may differ. Returns number of possible moves.
+uint8_t BitboardPossibleMoves_C(const BitboardsC* bitboards,
+                                enum Player player, MaxMovesPerPlayerC out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_BITBOARD_C_H_
@@ -1,17 +1,24 @@
 #ifndef XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_BOARD_H_
 #define XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_BOARD_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "xiangqi/board_c.h"
 #include "xiangqi/types.h"
 
 namespace xq {
 
 using MovesPerPiece = std::array<Position, K_MAX_MOVE_PER_PIECE>;
 
+using MoveUndo = MoveUndoC;
+
+using AttackMap = std::array<uint8_t, K_BOARD_SIZE>;
+
 constexpr Board kStartingBoard = {
     B_CHARIOT,   B_HORSE,     B_ELEPHANT,  B_ADVISOR,   B_GENERAL,
     B_ADVISOR,   B_ELEPHANT,  B_HORSE,     B_CHARIOT,  // Row 0
@@ -53,6 +60,12 @@ Board BoardFromString(std::string_view str);
 // C++ wrapper of BoardToString_C.
 std::string BoardToString(const Board& board);
 
+// C++ wrapper of BoardToFen_C.
+std::string BoardToFen(const Board& board, Player player);
+
+// C++ wrapper of BoardFromFen_C, does not allocate.
+bool BoardFromFen(std::string_view fen, Board& board, Player& player);
+
 // Check if two boards are identical.
 bool BoardEq(const Board& a, const Board& b);
 
@@ -64,12 +77,58 @@ Position FindGeneral(const Board& board, Player player);
 // C++ wrapper of IsBeingCheckmate_C.
 bool IsBeingCheckmate(const Board& board, Player player);
 
+// C++ wrapper of IsSquareAttacked_C.
+bool IsSquareAttacked(const Board& board, Position pos, Player by_player);
+
+// C++ wrapper of ComputeAttackMap_C.
+AttackMap ComputeAttackMap(const Board& board, Player player);
+
+using GivesCheckInfo = GivesCheckInfoC;
+
+// C++ wrapper of ComputeGivesCheckInfo_C.
+GivesCheckInfo ComputeGivesCheckInfo(const Board& board, Player player);
+
+// C++ wrapper of MoveGivesCheck_C.
+bool MoveGivesCheck(const Board& board, const GivesCheckInfo& info,
+                    Movement movement);
+
+// Same as MoveGivesCheck, for a single move of the piece at its origin.
+bool MoveGivesCheck(const Board& board, Movement movement);
+
+// C++ wrapper of StaticExchangeEval_C.
+int32_t StaticExchangeEval(const Board& board, Movement movement);
+
 // C++ wrapper of GetWinner_C.
 Winner GetWinner(const Board& board);
 
+// C++ wrapper of HasAnyLegalMove_C.
+bool HasAnyLegalMove(const Board& board, Player player);
+
 // C++ wrapper of DidPlayerLose_C.
 bool DidPlayerLose(const Board& board, Player player);
 
+// C++ wrapper of ZobristKey_C.
+uint64_t ZobristKey(const Board& board, Player player);
+
+// C++ wrapper of ZobristMoveKey_C.
+uint64_t ZobristMoveKey(uint64_t key, Piece piece, Piece captured,
+                        Movement movement);
+
+// C++ wrapper of ZobristMirrorKey_C.
+uint64_t ZobristMirrorKey(const Board& board, Player player);
+
+// C++ wrapper of ZobristMirrorMoveKey_C.
+uint64_t ZobristMirrorMoveKey(uint64_t mirror_key, Piece piece,
+                              Piece captured, Movement movement);
+
+using CanonicalKey = CanonicalKeyC;
+
+// C++ wrapper of SelectCanonicalKey_C.
+CanonicalKey SelectCanonicalKey(uint64_t key, uint64_t mirror_key);
+
+// C++ wrapper of CanonicalZobristKey_C.
+CanonicalKey CanonicalZobristKey(const Board& board, Player player);
+
 // C++ wrapper of FlipBoard_C.
 Board FlipBoard(const Board& board);
 
@@ -82,6 +141,12 @@ Board MirrorBoardVertical(const Board& board);
 // C++ wrapper of Move_C.
 Piece Move(Board& board, Movement movement);
 
+// C++ wrapper of MakeMove_C.
+Piece MakeMove(Board& board, Movement movement, MoveUndo& undo);
+
+// C++ wrapper of UnmakeMove_C.
+void UnmakeMove(Board& board, const MoveUndo& undo);
+
 // C++ wrapper of PossiblePositions_C.
 MovesPerPiece PossiblePositions(const Board& board, Position pos,
                                 bool avoid_checkmate = false);
@@ -90,6 +155,65 @@ MovesPerPiece PossiblePositions(const Board& board, Position pos,
 std::vector<Movement> PossibleMoves(const Board& board, Player player,
                                     bool avoid_checkmate = false);
 
+// C++ wrapper of PossibleCaptures_C.
+std::vector<Movement> PossibleCaptures(const Board& board, Player player,
+                                       bool avoid_checkmate = false);
+
+// C++ wrapper of PossibleQuietMoves_C.
+std::vector<Movement> PossibleQuietMoves(const Board& board, Player player,
+                                         bool avoid_checkmate = false);
+
+// C++ wrapper of PossibleEvasions_C.
+std::vector<Movement> PossibleEvasions(const Board& board, Player player);
+
+// Range over the boards after each possible move of player, wrapping
+// StartChildBoards_C. Moves are made and taken back one at a time on a single
+// copy of board, so children are produced on demand, stopping early skips the
+// rest and nothing is allocated. A child is only valid until the iterator is
+// advanced, and the range can only be walked once.
+//
+//   for (const Board& child : ChildBoards(board, player, true)) {...}
+class ChildBoards {
+ public:
+  class Iterator {
+   public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = Board;
+
+    Iterator() = default;
+    explicit Iterator(ChildBoards* children) : children_(children) {}
+
+    const Board& operator*() const { return children_->board_; }
+
+    // Move that leads to the current child.
+    Movement movement() const;
+
+    Iterator& operator++();
+    void operator++(int) { ++*this; }
+
+    bool operator==(std::default_sentinel_t) const { return children_->done_; }
+
+   private:
+    ChildBoards* children_ = nullptr;
+  };
+
+  ChildBoards(const Board& board, Player player, bool avoid_checkmate = false);
+  ChildBoards(const ChildBoards&) = delete;
+  ChildBoards& operator=(const ChildBoards&) = delete;
+
+  // Number of children.
+  size_t size() const { return children_.num_moves; }
+
+  // Makes the first move, must be called only once.
+  Iterator begin();
+  std::default_sentinel_t end() const { return {}; }
+
+ private:
+  Board board_;
+  ChildBoardsC children_;
+  bool done_ = false;
+};
+
 // Returns a vector of all possible boards for the given player after any valid
 // move.
 // If avoid_checkmate is set to true, moves that result in being checkmade
@@ -97,12 +221,40 @@ std::vector<Movement> PossibleMoves(const Board& board, Player player,
 std::vector<Board> PossibleBoards(const Board& board, Player player,
                                   bool avoid_checkmate = false);
 
+// Possible moves of a batch of boards, moves of the i-th board are
+// moves[offsets[i], offsets[i + 1]). Reusing the same batch across calls
+// avoids allocating once its buffers have grown.
+struct MoveBatch {
+  std::vector<Movement> moves;
+  std::vector<uint32_t> offsets;
+};
+
+// C++ wrapper of BatchPossibleMoves_C, players[i] is the player to move on
+// boards[i]. Results are written to out, replacing its previous content. out
+// is left as an empty batch if players and boards differ in size.
+void BatchPossibleMoves(const std::vector<Board>& boards,
+                        const std::vector<Player>& players,
+                        bool avoid_checkmate, MoveBatch& out);
+
+// C++ wrapper of BatchPossibleBoards_C, out[j] is the board after
+// batch.moves[j]. boards must be the boards batch was generated from.
+void BatchPossibleBoards(const std::vector<Board>& boards,
+                         const MoveBatch& batch, std::vector<Board>& out);
+
 // C++ wrapper of EncodeBoardState_C.
 BoardState EncodeBoardState(const Board& board);
 
 // C++ wrapper of DecodeBoardState_C.
 Board DecodeBoardState(const BoardState& state);
 
+// C++ wrapper of BoardStateMove_C.
+void BoardStateMove(BoardState& state, Piece piece, Piece captured,
+                    Movement movement);
+
+// C++ wrapper of BoardStateUnmove_C.
+void BoardStateUnmove(BoardState& state, Piece piece, Piece captured,
+                      Movement movement);
+
 }  // namespace xq
 
 #endif  // XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_BOARD_H_
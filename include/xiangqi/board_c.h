@@ -1,6 +1,8 @@
 #ifndef XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_BOARD_C_H_
 #define XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_BOARD_C_H_
 
+#include <stddef.h>
+
 #include "xiangqi/types_c.h"
 
 #ifdef __cplusplus
@@ -11,9 +13,15 @@ typedef Position MovesPerPieceC[K_MAX_MOVE_PER_PIECE];
 
 typedef Movement MaxMovesPerPlayerC[K_MAX_MOVE_PER_PLAYER];
 
+typedef uint8_t AttackMapC[K_BOARD_SIZE];
+
 #define K_BOARD_STR_SIZE 232
 
-const BoardC K_STARTING_BOARD = {
+// Longest WXF FEN written by BoardToFen_C, including the null terminator: one
+// piece per position, 9 rank separators and " w - - 0 1".
+#define K_FEN_STR_SIZE 110
+
+static const BoardC K_STARTING_BOARD = {
     B_CHARIOT,   B_HORSE,     B_ELEPHANT,  B_ADVISOR,   B_GENERAL,
     B_ADVISOR,   B_ELEPHANT,  B_HORSE,     B_CHARIOT,  // Row 0
     PIECE_EMPTY, PIECE_EMPTY, PIECE_EMPTY, PIECE_EMPTY, PIECE_EMPTY,
@@ -39,6 +47,21 @@ const BoardC K_STARTING_BOARD = {
 // Human-readable string representation of board.
 void BoardToString_C(const BoardC board, char out[K_BOARD_STR_SIZE]);
 
+// Writes the WXF FEN of board with player to move, e.g.
+// "rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR w - - 0 1" for
+// the starting board. Returns the length of out without the null terminator.
+uint8_t BoardToFen_C(const BoardC board, enum Player player,
+                     char out[K_FEN_STR_SIZE]);
+
+// Parses the first size characters of a WXF FEN into board and player. H and E
+// are accepted for horses and elephants besides N and B, "r" for red to move
+// besides "w". Red moves if the side to move is missing, fields after it are
+// ignored. Returns false if the piece placement does not have exactly 10 ranks
+// of 9 positions or the side to move is unknown, board and player are then
+// unspecified.
+bool BoardFromFen_C(const char* fen, size_t size, BoardC board,
+                    enum Player* player);
+
 // Remove all pieces from board.
 void ClearBoard_C(BoardC board);
 
@@ -51,6 +74,9 @@ void CopyBoard_C(BoardC dest, const BoardC src);
 // Copies destination board from source board.
 void CopyBoard_C(BoardC dest, const BoardC src);
 
+// Returns true if both boards have the same piece at every position.
+bool BoardEq_C(const BoardC a, const BoardC b);
+
 // Returns the position of a player's general. If the player's general was
 // captured, return kNoPosition.
 Position FindGeneral_C(const BoardC board, enum Player player);
@@ -60,6 +86,55 @@ Position FindGeneral_C(const BoardC board, enum Player player);
 // the general with their next move.
 bool IsBeingCheckmate_C(const BoardC board, enum Player player);
 
+// Returns true if a piece of by_player could capture an opponent's piece at
+// pos, whatever is at pos now. I.e. pos is attacked if it holds a piece of the
+// other player, and defended if it holds one of by_player's own. Only looks
+// at the positions a piece could attack pos from.
+bool IsSquareAttacked_C(const BoardC board, Position pos,
+                        enum Player by_player);
+
+// Counts the pieces of player attacking each position, in the same sense as
+// IsSquareAttacked_C, in a single pass over player's pieces.
+void ComputeAttackMap_C(const BoardC board, enum Player player,
+                        AttackMapC out);
+
+// What MoveGivesCheck_C needs to know about the board before player moves,
+// computed once and shared by all of player's moves on that board.
+typedef struct {
+  enum Player player;
+  // Position of the opponent's general, K_NO_POSITION if it was captured.
+  Position general;
+  // Whether player already attacks the opponent's general.
+  bool attacked;
+} GivesCheckInfoC;
+
+void ComputeGivesCheckInfo_C(const BoardC board, enum Player player,
+                             GivesCheckInfoC* out);
+
+// Returns true if player's movement puts the opponent in check, same as making
+// it and calling IsBeingCheckmate_C for the opponent, but without touching the
+// board. Discovered checks, cannon screens that appear or disappear and
+// unblocked horse legs are all covered. Only moves from or to the general's
+// rank, file or diagonal neighbors (the legs of horses attacking it) look
+// past the moved piece itself.
+bool MoveGivesCheck_C(const BoardC board, const GivesCheckInfoC* info,
+                      Movement movement);
+
+// Material value of each piece type used by StaticExchangeEval_C, indexed by
+// the absolute value of Piece, in hundredths of a soldier. Capturing the
+// general ends the game, so it outweighs all other pieces together.
+static const int16_t K_PIECE_VALUES[8] = {0, 10000, 200, 200, 400, 900, 450,
+                                          100};
+
+// Static exchange evaluation of movement: the material the moving side wins
+// on the destination once both sides keep capturing there with their least
+// valuable attacker, each side stopping when continuing would lose material.
+// Attackers are found again after every capture, so pieces moving off a line
+// reveal chariots and cannons behind them and change cannon screens and horse
+// legs. Quiet moves are evaluated as a capture of nothing. Legality of the
+// captures (e.g. pins) is not checked.
+int32_t StaticExchangeEval_C(const BoardC board, Movement movement);
+
 // Returns the winner if one of the player's general is captured, returns NONE
 // if both generals are on the board.
 // Note that this function does not perform a future-looking search to check
@@ -71,6 +146,66 @@ enum Winner GetWinner_C(const BoardC board);
 // piece. If no piece was captured, return EMPTY.
 enum Piece Move_C(BoardC board, Movement movement);
 
+// Index of an empty position in TrackedBoardC.index.
+#define K_NO_PIECE_INDEX 0xFF
+
+// Everything needed to take back a move made by MakeMove_C or
+// TrackedMakeMove_C.
+typedef struct {
+  // K_NO_MOVEMENT if the move did not change the board.
+  Movement movement;
+  enum Piece captured;
+  // Index of the captured piece in its owner's piece list, only set by
+  // TrackedMakeMove_C.
+  uint8_t captured_index;
+} MoveUndoC;
+
+// Same as Move_C, also fills in the undo record so that the move can be taken
+// back in place with UnmakeMove_C.
+enum Piece MakeMove_C(BoardC board, Movement movement, MoveUndoC* undo);
+
+// Takes back a move made by MakeMove_C. Moves must be taken back in the
+// reverse order they were made.
+void UnmakeMove_C(BoardC board, const MoveUndoC* undo);
+
+// 64-bit Zobrist key of a board with the given player to move, a cheap
+// identity of a position for transposition tables and repetition detection.
+uint64_t ZobristKey_C(const BoardC board, enum Player player);
+
+// Updates the Zobrist key of a position for a move of piece that captures
+// captured (PIECE_EMPTY if none), also switching the player to move. If the
+// move does not change the board (e.g. piece is PIECE_EMPTY), only the player
+// to move is switched. Applying the same update again takes the move back.
+uint64_t ZobristMoveKey_C(uint64_t key, enum Piece piece, enum Piece captured,
+                          Movement movement);
+
+// Same as ZobristKey_C of the board mirrored by MirrorBoardHorizontal_C,
+// without building the mirrored board.
+uint64_t ZobristMirrorKey_C(const BoardC board, enum Player player);
+
+// Same as ZobristMoveKey_C for a key from ZobristMirrorKey_C, movement is made
+// on the original board.
+uint64_t ZobristMirrorMoveKey_C(uint64_t mirror_key, enum Piece piece,
+                                enum Piece captured, Movement movement);
+
+// Key shared by a position and its left-right mirror, so that tables keyed on
+// it store each pair of mirrored positions once.
+typedef struct {
+  uint64_t key;
+  // True if key is the mirrored board's key. Boards and moves looked up with
+  // key must then be mirrored with MirrorBoardHorizontal_C and
+  // MirrorMovementHorizontal. Symmetric positions are never mirrored.
+  bool mirrored;
+} CanonicalKeyC;
+
+// Picks the canonical key of a position from its Zobrist key and the key of
+// its mirror, both of which can be updated incrementally on every move.
+CanonicalKeyC SelectCanonicalKey_C(uint64_t key, uint64_t mirror_key);
+
+// Same as SelectCanonicalKey_C with both keys computed from scratch in one
+// pass over the board.
+CanonicalKeyC CanonicalZobristKey_C(const BoardC board, enum Player player);
+
 // Rotate the board 180 degrees so that it's from the opponent's perspective.
 // Red and black pieces are also flipped.
 void FlipBoard_C(BoardC dest, const BoardC src);
@@ -85,8 +220,10 @@ void MirrorBoardVertical_C(BoardC dest, const BoardC src);
 // game AI to identify a unique board state.
 //
 // There are a total of 32 pieces on the board, so the encoded board state is
-// 32 bytes, with each byte representing the row and column of that piece
-// (4 bits for each). If the piece is not present, use 0xF to represent it.
+// 32 bytes, with each byte holding the position of one piece. If the piece is
+// not present, use K_NO_POSITION to represent it. Red pieces come first: the
+// general, advisors, elephants, horses, chariots, cannons and soldiers, then
+// black pieces in the same order.
 // To make sure the same piece for the same player is treated in the same way,
 // all byte representations of a group of piece is sorted.
 void EncodeBoardState_C(const BoardC board, BoardStateC out);
@@ -94,6 +231,18 @@ void EncodeBoardState_C(const BoardC board, BoardStateC out);
 // Decode the encoded board state back to its original state.
 void DecodeBoardState_C(const BoardStateC state, BoardC out);
 
+// Updates state, the encoding of a board, for a move of piece that captures
+// captured (PIECE_EMPTY if none), the same as encoding the board after the
+// move. If the move does not change the board (e.g. piece is PIECE_EMPTY),
+// state is unchanged. Boards must have at most as many pieces of each kind as
+// the starting board.
+void BoardStateMove_C(BoardStateC state, enum Piece piece, enum Piece captured,
+                      Movement movement);
+
+// Takes back BoardStateMove_C called with the same arguments.
+void BoardStateUnmove_C(BoardStateC state, enum Piece piece,
+                        enum Piece captured, Movement movement);
+
 // Get all possible moves for the player with piece at position. Impossible
 // moves are filled with kNoPosition. Returns number of possible moves.
 // If avoid_checkmate is set to true, moves that result in being checkmade
@@ -106,6 +255,25 @@ uint8_t PossiblePositions_C(const BoardC board, Position pos,
 uint8_t PossibleMoves_C(const BoardC board, enum Player player,
                         bool avoid_checkmate, MaxMovesPerPlayerC out);
 
+// Get all possible moves for player that capture an opponent's piece. Only
+// out[0, return value) is written. If avoid_checkmate is set to true, moves
+// that result in being checkmade will not be included.
+uint8_t PossibleCaptures_C(const BoardC board, enum Player player,
+                           bool avoid_checkmate, MaxMovesPerPlayerC out);
+
+// Get all possible moves for player to an empty position. Only
+// out[0, return value) is written. If avoid_checkmate is set to true, moves
+// that result in being checkmade will not be included.
+uint8_t PossibleQuietMoves_C(const BoardC board, enum Player player,
+                             bool avoid_checkmate, MaxMovesPerPlayerC out);
+
+// Get all moves that get player out of check, meant to be called instead of
+// the other generators when IsBeingCheckmate_C is true for player. Only moves
+// that can resolve the checks are verified, so this is much cheaper than
+// filtering every possible move. Only out[0, return value) is written.
+uint8_t PossibleEvasions_C(const BoardC board, enum Player player,
+                           MaxMovesPerPlayerC out);
+
 // Returns a vector of all possible boards for the given player after any valid
 // move.
 // If avoid_checkmate is set to true, moves that result in being checkmade
@@ -114,6 +282,59 @@ uint8_t PossibleBoards_C(const BoardC board, enum Player player,
                          bool avoid_checkmate,
                          enum Piece out[K_BOARD_SIZE * K_MAX_MOVE_PER_PLAYER]);
 
+// State of a walk over the boards after each possible move, see
+// StartChildBoards_C.
+typedef struct {
+  MaxMovesPerPlayerC moves;
+  uint8_t num_moves;
+  // Index of the next move to make, moves[next - 1] is on the board.
+  uint8_t next;
+  MoveUndoC undo;
+} ChildBoardsC;
+
+// Starts a walk over the boards after each possible move of player, without
+// copying any of them. board is not changed until NextChildBoard_C is called.
+// Returns number of children.
+uint8_t StartChildBoards_C(const BoardC board, enum Player player,
+                           bool avoid_checkmate, ChildBoardsC* children);
+
+// Takes back the previous child's move on board and makes the next one, so
+// that board holds the next child. The move is children->moves[next - 1].
+// Returns false once all children were visited, and board is the original
+// board again. Stopping early leaves board at the current child, call
+// StopChildBoards_C to restore it.
+bool NextChildBoard_C(BoardC board, ChildBoardsC* children);
+
+// Takes back the current child's move on board, if any, and ends the walk.
+void StopChildBoards_C(BoardC board, ChildBoardsC* children);
+
+// Get all possible moves of many boards at once. boards holds num_boards
+// boards back to back, and players[i] is the player to move on the i-th one.
+// Moves of the i-th board are written to moves_out[offsets_out[i],
+// offsets_out[i + 1]), so offsets_out must hold num_boards + 1 entries and
+// moves_out num_boards * K_MAX_MOVE_PER_PLAYER. Returns the total number of
+// moves, which is also offsets_out[num_boards].
+// Inputs and outputs are separate flat arrays rather than per-board structs,
+// so that a whole batch is walked with unit stride.
+uint32_t BatchPossibleMoves_C(const enum Piece* boards,
+                              const enum Player* players, uint32_t num_boards,
+                              bool avoid_checkmate, Movement* moves_out,
+                              uint32_t* offsets_out);
+
+// Applies the moves produced by BatchPossibleMoves_C to their boards. The
+// board after moves[j] is written to boards_out[j * K_BOARD_SIZE], so
+// boards_out must hold offsets[num_boards] boards.
+void BatchPossibleBoards_C(const enum Piece* boards, uint32_t num_boards,
+                           const Movement* moves, const uint32_t* offsets,
+                           enum Piece* boards_out);
+
+// Returns true if player has at least one move that does not result in being
+// checkmate, i.e. PossibleMoves_C with avoid_checkmate would return any moves.
+// Stops at the first such move. Out of check, moves of pieces that cannot
+// expose the general are tried first and need no verification; in check, only
+// moves that can resolve the check are tried.
+bool HasAnyLegalMove_C(const BoardC board, enum Player player);
+
 // Returns true if all possible moves of the given player still result in the
 // player being checkmate.
 bool DidPlayerLose_C(const BoardC board, enum Player player);
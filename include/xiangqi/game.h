@@ -6,6 +6,7 @@
 #include <utility>
 #include <vector>
 
+#include "xiangqi/board.h"
 #include "xiangqi/types.h"
 
 namespace xq {
@@ -22,6 +23,10 @@ class Game {
   // Returns the number of moves has been made in this game.
   size_t MovesCount() const;
 
+  // Returns the number of moves recorded in this game, including the ones
+  // after the current ply that were undone or sought past.
+  size_t RecordedMovesCount() const;
+
   // Change the starting turn to Black.
   void MakeBlackMoveFirst();
 
@@ -31,8 +36,36 @@ class Game {
   // Return reference of current board.
   const Board& CurrentBoard() const;
 
+  // Zobrist key of the current board and player, same as
+  // ZobristKey(CurrentBoard(), CurrentPlayer()). Updated incrementally on
+  // every move and undo.
+  uint64_t Key() const;
+
+  // Same as ZobristMirrorKey(CurrentBoard(), CurrentPlayer()), updated
+  // incrementally like Key().
+  uint64_t MirrorKey() const;
+
+  // Same as CanonicalZobristKey(CurrentBoard(), CurrentPlayer()), picked from
+  // Key() and MirrorKey().
+  CanonicalKey CanonicalZobristKey() const;
+
+  // Encoded state of the current board, same as
+  // EncodeBoardState(CurrentBoard()). Updated incrementally on every move and
+  // undo.
+  const BoardState& CurrentBoardState() const;
+
+  // Number of earlier plies with the same position and player to move as the
+  // current one. Only plies since the last irreversible move (a capture or a
+  // soldier moving forward) are compared, since no earlier position can come
+  // back.
+  size_t RepetitionCount() const;
+
+  // Whether the current position already occurred earlier in the game.
+  bool IsRepetition() const;
+
   // Move a piece from a position to another position, returns the captured
-  // piece. If no piece was captured, return EMPTY.
+  // piece. If no piece was captured, return EMPTY. Recorded moves after the
+  // current ply are dropped, unless the next recorded move is the same one.
   Piece Move(Movement move);
 
   // Whether or not the player can perform undo action.
@@ -40,8 +73,15 @@ class Game {
 
   // Undo last move. Returns the move action that was reversed. Cannot undo
   // if the board is already at its original state when initialized or reset.
+  // The move stays recorded and can be sought back to.
   Movement Undo();
 
+  // Jumps to the position after the first ply moves of the recorded game,
+  // backward or forward. Replays at most kCheckpointInterval - 1 moves from
+  // the closest board snapshot. Returns false and does nothing if ply is
+  // larger than RecordedMovesCount().
+  bool SeekToPly(size_t ply);
+
   // Get initial encoded board state.
   BoardState InitialBoardState() const;
 
@@ -53,15 +93,49 @@ class Game {
   // Restores game state from inital state.
   void RestoreBoard(const BoardState& state);
 
-  // Restores game state from exported moves.
+  // Restores game state from exported moves, played from the initial board.
+  // The part shared with the recorded game is sought to instead of replayed.
   void RestoreMoves(const std::vector<Movement>& moves);
 
+  // Number of plies between two board snapshots kept for SeekToPly.
+  static constexpr size_t kCheckpointInterval = 16;
+
  private:
   Player player_ = PLAYER_RED;
+  // Player to move before the first recorded move.
+  Player first_player_ = PLAYER_RED;
   std::optional<BoardState> initial_board_state_ = std::nullopt;
   Board board_;
-  std::vector<Piece> captured_;
+  uint64_t key_;
+  uint64_t mirror_key_;
+  BoardState board_state_;
+  // Recorded moves and what it takes to take them back, the first ply_ of
+  // which have been made on board_.
+  std::vector<MoveUndo> undos_;
   std::vector<Movement> moves_;
+  size_t ply_ = 0;
+  // Board after every kCheckpointInterval plies of the recorded game,
+  // starting with the initial board.
+  std::vector<Board> checkpoints_;
+  // Key() after each recorded ply, starting with the position before the
+  // first move.
+  std::vector<uint64_t> keys_;
+  // Indices into keys_ of the positions right after irreversible moves, in
+  // increasing order.
+  std::vector<size_t> irreversible_plies_;
+
+  // Restarts the recorded game from the current position.
+  void ResetRecord();
+
+  // Sets the current ply of the recorded game, with its player and key.
+  // board_, mirror_key_ and board_state_ are left to the caller.
+  void SetPly(size_t ply);
+
+  // Drops recorded moves after the current ply.
+  void TruncateRecord();
+
+  // Records key_ after move of piece that captured captured.
+  void PushKey(Piece piece, Piece captured, Movement move);
 };
 
 }  // namespace xq
@@ -0,0 +1,705 @@
+#ifndef XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_INTERNAL_MOVE_GEN_C_H_
+#define XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_INTERNAL_MOVE_GEN_C_H_
+
+#include "xiangqi/bitboard_c.h"
+#include "xiangqi/internal/tables_c.h"
+#include "xiangqi/types_c.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Per-piece pseudo-legal move generators and attack tests on a mailbox board,
+// shared by every board representation that keeps a BoardC around.
+
+// Returns true if a piece of the given color can move to a position occupied
+// by target, i.e. it is empty or occupied by the opponent.
+static inline bool CanCapture(const enum Piece target, const bool is_red) {
+  return is_red ? target <= 0 : target >= 0;
+}
+
+// Returns true if pos is on the given rank or file slide masks of a piece at
+// (row, col).
+static inline bool OnSlide(const uint16_t rank_mask, const uint16_t file_mask,
+                           const uint8_t row, const uint8_t col,
+                           const Position pos) {
+  const uint8_t pos_row = Row(pos);
+  const uint8_t pos_col = Col(pos);
+  return (pos_row == row && ((rank_mask >> pos_col) & 1)) ||
+         (pos_col == col && ((file_mask >> pos_row) & 1));
+}
+
+static inline bool ThreatensBySoldier(const enum Piece soldier,
+                                      const Position pos,
+                                      const Position target) {
+  if (soldier != R_SOLDIER && soldier != B_SOLDIER) {
+    return false;
+  }
+  const StepsC* steps =
+      &K_LEAPER_TABLES.soldier[IsRed(soldier) ? PLAYER_RED : PLAYER_BLACK][pos];
+  for (uint8_t i = 0; i < steps->count; i++) {
+    if (steps->dests[i] == target) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static inline bool ThreatensByHorse(const BoardC board, const Position pos,
+                                    const Position target) {
+  const HorseLeapsC* leaps = &K_LEAPER_TABLES.horse[pos];
+  for (uint8_t i = 0; i < leaps->count; i++) {
+    if (leaps->leaps[i].dest == target) {
+      return IsEmpty(board[leaps->leaps[i].block]);
+    }
+  }
+  return false;
+}
+
+// Generators below take the player owning the piece instead of reading its
+// color from the board. Callers that pass a constant player get a copy where
+// every color test, palace and river lookup is folded at compile time, see
+// PossibleMovesOfKind in board.c.
+#if defined(__GNUC__)
+#define FORCE_INLINE static inline __attribute__((always_inline))
+#else
+#define FORCE_INLINE static inline
+#endif
+
+FORCE_INLINE uint8_t PossiblePositionsGeneral(const BoardC board,
+                                              const Position pos,
+                                              const enum Player player,
+                                              const Position opponent_general,
+                                              const uint16_t file_occupancy,
+                                              Position* out) {
+  uint8_t res = 0;
+
+  // Flying general check.
+  if (opponent_general != K_NO_POSITION && Col(opponent_general) == Col(pos) &&
+      ((K_SLIDER_TABLES.file[Row(pos)][file_occupancy].chariot >>
+        Row(opponent_general)) &
+       1)) {
+    *(out + res++) = opponent_general;
+  }
+
+  const bool is_red = player == PLAYER_RED;
+  const StepsC* steps = &K_LEAPER_TABLES.general[player][pos];
+  for (uint8_t i = 0; i < steps->count; i++) {
+    const Position dest = steps->dests[i];
+    if (CanCapture(board[dest], is_red)) {
+      *(out + res++) = dest;
+    }
+  }
+  return res;
+}
+
+FORCE_INLINE uint8_t PossiblePositionsAdvisor(const BoardC board,
+                                              const Position pos,
+                                              const enum Player player,
+                                              Position* out) {
+  const bool is_red = player == PLAYER_RED;
+  const StepsC* steps = &K_LEAPER_TABLES.advisor[player][pos];
+  uint8_t res = 0;
+  for (uint8_t i = 0; i < steps->count; i++) {
+    const Position dest = steps->dests[i];
+    if (CanCapture(board[dest], is_red)) {
+      *(out + res++) = dest;
+    }
+  }
+  return res;
+}
+
+FORCE_INLINE uint8_t PossiblePositionsElephant(const BoardC board,
+                                               const Position pos,
+                                               const enum Player player,
+                                               Position* out) {
+  const bool is_red = player == PLAYER_RED;
+  const ElephantLeapsC* leaps = &K_LEAPER_TABLES.elephant[player][pos];
+  uint8_t res = 0;
+  for (uint8_t i = 0; i < leaps->count; i++) {
+    const LeapC leap = leaps->leaps[i];
+    if (IsEmpty(board[leap.block]) && CanCapture(board[leap.dest], is_red)) {
+      *(out + res++) = leap.dest;
+    }
+  }
+  return res;
+}
+
+FORCE_INLINE uint8_t PossiblePositionsHorse(const BoardC board,
+                                            const Position pos,
+                                            const enum Player player,
+                                            Position* out) {
+  const bool is_red = player == PLAYER_RED;
+  const HorseLeapsC* leaps = &K_LEAPER_TABLES.horse[pos];
+  uint8_t res = 0;
+  for (uint8_t i = 0; i < leaps->count; i++) {
+    const LeapC leap = leaps->leaps[i];
+    if (IsEmpty(board[leap.block]) && CanCapture(board[leap.dest], is_red)) {
+      *(out + res++) = leap.dest;
+    }
+  }
+  return res;
+}
+
+// Adds positions on the rank and file masks of a slider at pos that are either
+// empty or occupied by the opponent.
+FORCE_INLINE uint8_t AddSlidePositions(const BoardC board, const Position pos,
+                                       const enum Player player,
+                                       uint16_t rank_mask, uint16_t file_mask,
+                                       Position* out) {
+  const bool is_red = player == PLAYER_RED;
+  const Position rank_start = pos - Col(pos);
+  const Position col = Col(pos);
+  uint8_t res = 0;
+  while (rank_mask) {
+    const Position dest = rank_start + __builtin_ctz(rank_mask);
+    rank_mask &= rank_mask - 1;
+    if (CanCapture(board[dest], is_red)) {
+      *(out + res++) = dest;
+    }
+  }
+  while (file_mask) {
+    const Position dest = __builtin_ctz(file_mask) * K_TOTAL_COL + col;
+    file_mask &= file_mask - 1;
+    if (CanCapture(board[dest], is_red)) {
+      *(out + res++) = dest;
+    }
+  }
+  return res;
+}
+
+FORCE_INLINE uint8_t PossiblePositionsSoldier(const BoardC board,
+                                              const Position pos,
+                                              const enum Player player,
+                                              Position* out) {
+  const bool is_red = player == PLAYER_RED;
+  const StepsC* steps = &K_LEAPER_TABLES.soldier[player][pos];
+  uint8_t res = 0;
+  for (uint8_t i = 0; i < steps->count; i++) {
+    const Position dest = steps->dests[i];
+    if (CanCapture(board[dest], is_red)) {
+      *(out + res++) = dest;
+    }
+  }
+  return res;
+}
+
+// Kinds of pseudo-legal moves generated by PseudoPositionsOfKind.
+enum MoveKind : uint8_t {
+  MOVE_KIND_ALL = 0,
+  // Moves to a position occupied by the opponent.
+  MOVE_KIND_CAPTURES = 1,
+  // Moves to an empty position.
+  MOVE_KIND_QUIETS = 2,
+};
+
+// Pseudo-legal destinations of player's piece at pos, limited to moves of the
+// given kind. The opponent's general is passed in for the flying general
+// rule. Slider targets are masked before they are expanded, other pieces are
+// filtered after being generated. Returns number of destinations.
+FORCE_INLINE uint8_t PlayerPseudoPositions(const BoardC board,
+                                           const Position pos,
+                                           const enum Player player,
+                                           const Position opponent_general,
+                                           const enum MoveKind kind,
+                                           Position* out) {
+  // Pieces of either player map to their red counterpart, so that only half
+  // of the cases are left once player is known.
+  const int8_t piece = player == PLAYER_RED ? board[pos] : -board[pos];
+  uint8_t res = 0;
+  switch (piece) {
+    case R_CHARIOT:
+    case R_CANNON: {
+      const uint16_t rank_occupancy = RankOccupancy(board, Row(pos));
+      const uint16_t file_occupancy = FileOccupancy(board, Col(pos));
+      const SlideC rank = K_SLIDER_TABLES.rank[Col(pos)][rank_occupancy];
+      const SlideC file = K_SLIDER_TABLES.file[Row(pos)][file_occupancy];
+      const bool is_chariot = piece == R_CHARIOT;
+      uint16_t rank_mask = is_chariot ? rank.chariot : rank.cannon;
+      uint16_t file_mask = is_chariot ? file.chariot : file.cannon;
+      if (kind == MOVE_KIND_CAPTURES) {
+        rank_mask &= rank_occupancy;
+        file_mask &= file_occupancy;
+      } else if (kind == MOVE_KIND_QUIETS) {
+        rank_mask &= ~rank_occupancy;
+        file_mask &= ~file_occupancy;
+      }
+      return AddSlidePositions(board, pos, player, rank_mask, file_mask, out);
+    }
+    case R_GENERAL:
+      res = PossiblePositionsGeneral(board, pos, player, opponent_general,
+                                     FileOccupancy(board, Col(pos)), out);
+      break;
+    case R_ADVISOR:
+      res = PossiblePositionsAdvisor(board, pos, player, out);
+      break;
+    case R_ELEPHANT:
+      res = PossiblePositionsElephant(board, pos, player, out);
+      break;
+    case R_HORSE:
+      res = PossiblePositionsHorse(board, pos, player, out);
+      break;
+    case R_SOLDIER:
+      res = PossiblePositionsSoldier(board, pos, player, out);
+      break;
+    default:
+      return 0;
+  }
+
+  if (kind == MOVE_KIND_ALL) {
+    return res;
+  }
+  const bool want_empty = kind == MOVE_KIND_QUIETS;
+  uint8_t kept = 0;
+  for (uint8_t i = 0; i < res; i++) {
+    if (IsEmpty(board[out[i]]) == want_empty) {
+      out[kept++] = out[i];
+    }
+  }
+  return kept;
+}
+
+// Same as PlayerPseudoPositions, the owner is read from the board.
+static inline uint8_t PseudoPositionsOfKind(const BoardC board,
+                                            const Position pos,
+                                            const Position opponent_general,
+                                            const enum MoveKind kind,
+                                            Position* out) {
+  return PlayerPseudoPositions(board, pos,
+                               IsRed(board[pos]) ? PLAYER_RED : PLAYER_BLACK,
+                               opponent_general, kind, out);
+}
+
+// Pseudo-legal destinations of the piece at pos, the opponent's general is
+// passed in for the flying general rule. Returns number of destinations.
+static inline uint8_t PseudoPossiblePositions(const BoardC board,
+                                              const Position pos,
+                                              const Position opponent_general,
+                                              Position* out) {
+  return PseudoPositionsOfKind(board, pos, opponent_general, MOVE_KIND_ALL,
+                               out);
+}
+
+// Slides from a general's position, a chariot or a cannon threatens the
+// general if and only if the general could reach it in the same way. Looked
+// up lazily, only once a slider is found on the general's rank or file.
+typedef struct {
+  Position general;
+  bool ready;
+  SlideC rank;
+  SlideC file;
+} GeneralSlidesC;
+
+static inline GeneralSlidesC NewGeneralSlides(const Position general) {
+  GeneralSlidesC res = {general, false, {0, 0}, {0, 0}};
+  return res;
+}
+
+// Returns true if the opponent's piece at pos threatens the general.
+static inline bool ThreatensGeneral(const BoardC board, const Position pos,
+                                    GeneralSlidesC* slides) {
+  const enum Piece piece = board[pos];
+  const Position general = slides->general;
+  const uint8_t general_row = Row(general);
+  const uint8_t general_col = Col(general);
+  switch (piece > 0 ? piece : -piece) {
+    case R_GENERAL:
+    case R_CHARIOT:
+    case R_CANNON:
+      if (Row(pos) != general_row && Col(pos) != general_col) {
+        return false;
+      }
+      if (!slides->ready) {
+        const uint16_t rank_occupancy = RankOccupancy(board, general_row);
+        const uint16_t file_occupancy = FileOccupancy(board, general_col);
+        slides->rank = K_SLIDER_TABLES.rank[general_col][rank_occupancy];
+        slides->file = K_SLIDER_TABLES.file[general_row][file_occupancy];
+        slides->ready = true;
+      }
+      if (piece == R_CANNON || piece == B_CANNON) {
+        return OnSlide(slides->rank.cannon, slides->file.cannon, general_row,
+                       general_col, pos);
+      }
+      return OnSlide(slides->rank.chariot, slides->file.chariot, general_row,
+                     general_col, pos);
+    case R_SOLDIER:
+      return ThreatensBySoldier(piece, pos, general);
+    case R_HORSE:
+      return ThreatensByHorse(board, pos, general);
+    default:
+      return false;
+  }
+}
+
+static inline bool StepsHave(const StepsC* steps, const Position pos) {
+  for (uint8_t i = 0; i < steps->count; i++) {
+    if (steps->dests[i] == pos) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Piece at pos once movement is made on board, without making it. movement
+// may be K_NO_MOVEMENT, in which case this is board[pos].
+FORCE_INLINE enum Piece PieceAfterMove(const BoardC board, const Position pos,
+                                       const Movement movement) {
+  if (movement == K_NO_MOVEMENT) {
+    return board[pos];
+  }
+  return pos == Dest(movement)   ? board[Orig(movement)]
+         : pos == Orig(movement) ? PIECE_EMPTY
+                                 : board[pos];
+}
+
+// Same as PlayerAttacks, on the board after movement. Pass K_NO_MOVEMENT as a
+// constant to look at board as it is.
+FORCE_INLINE bool PlayerAttacksAfterMove(const BoardC board, const Position pos,
+                                         const enum Player player,
+                                         const Movement movement) {
+  const int8_t sign = player == PLAYER_RED ? 1 : -1;
+  for (uint8_t d = 0; d < K_TOTAL_DIRECTIONS; d++) {
+    const Position* ray = K_SQUARE_TABLES.rays[pos][d];
+    if (*ray == K_NO_POSITION) {
+      continue;
+    }
+    // Adjacent pieces that step onto pos.
+    const enum Piece adjacent = PieceAfterMove(board, *ray, movement);
+    if ((adjacent == sign * R_SOLDIER &&
+         StepsHave(&K_LEAPER_TABLES.soldier[player][*ray], pos)) ||
+        (adjacent == sign * R_GENERAL &&
+         StepsHave(&K_LEAPER_TABLES.general[player][*ray], pos))) {
+      return true;
+    }
+    // The first piece in each direction may be a chariot or a facing general,
+    // the second one a cannon.
+    while (*ray != K_NO_POSITION &&
+           IsEmpty(PieceAfterMove(board, *ray, movement))) {
+      ray++;
+    }
+    if (*ray == K_NO_POSITION) {
+      continue;
+    }
+    const enum Piece first = PieceAfterMove(board, *ray, movement);
+    if (first == sign * R_CHARIOT ||
+        (first == sign * R_GENERAL &&
+         PieceAfterMove(board, pos, movement) == -sign * R_GENERAL)) {
+      return true;
+    }
+    for (ray++; *ray != K_NO_POSITION; ray++) {
+      const enum Piece second = PieceAfterMove(board, *ray, movement);
+      if (!IsEmpty(second)) {
+        if (second == sign * R_CANNON) {
+          return true;
+        }
+        break;
+      }
+    }
+  }
+  for (const Position* diagonal = K_SQUARE_TABLES.diagonals[pos];
+       *diagonal != K_NO_POSITION; diagonal++) {
+    if (PieceAfterMove(board, *diagonal, movement) == sign * R_ADVISOR &&
+        StepsHave(&K_LEAPER_TABLES.advisor[player][*diagonal], pos)) {
+      return true;
+    }
+  }
+  // Elephant leaps are symmetric, including the position of the eye.
+  const ElephantLeapsC* elephant = &K_LEAPER_TABLES.elephant[player][pos];
+  for (uint8_t i = 0; i < elephant->count; i++) {
+    const LeapC leap = elephant->leaps[i];
+    if (PieceAfterMove(board, leap.dest, movement) == sign * R_ELEPHANT &&
+        IsEmpty(PieceAfterMove(board, leap.block, movement))) {
+      return true;
+    }
+  }
+  // Horse leaps are symmetric, but the leg is next to the horse.
+  const HorseLeapsC* horse = &K_LEAPER_TABLES.horse[pos];
+  for (uint8_t i = 0; i < horse->count; i++) {
+    const Position from = horse->leaps[i].dest;
+    if (PieceAfterMove(board, from, movement) != sign * R_HORSE) {
+      continue;
+    }
+    const HorseLeapsC* leaps = &K_LEAPER_TABLES.horse[from];
+    for (uint8_t j = 0; j < leaps->count; j++) {
+      if (leaps->leaps[j].dest == pos &&
+          IsEmpty(PieceAfterMove(board, leaps->leaps[j].block, movement))) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Returns true if a piece of player could capture an opponent's piece at pos,
+// i.e. pos is attacked if it holds an opponent's piece and defended if it holds
+// one of player's own. Only the few positions a piece could attack pos from are
+// visited, instead of every piece of player. A general only attacks along its
+// file if pos holds the opponent's general (flying general).
+FORCE_INLINE bool PlayerAttacks(const BoardC board, const Position pos,
+                                const enum Player player) {
+  return PlayerAttacksAfterMove(board, pos, player, K_NO_MOVEMENT);
+}
+
+// Keeps candidate as best if the piece there is cheaper than the current
+// best.
+static inline void KeepCheaper(const BoardC board, const int16_t* values,
+                               const Position candidate, Position* best,
+                               int16_t* best_value) {
+  const enum Piece piece = board[candidate];
+  const int16_t value = values[piece > 0 ? piece : -piece];
+  if (value < *best_value) {
+    *best = candidate;
+    *best_value = value;
+  }
+}
+
+// Returns the position of the least valuable piece of player attacking pos, in
+// the same sense as PlayerAttacks, K_NO_POSITION if there is none. values is
+// indexed by the absolute value of Piece.
+static inline Position LeastValuableAttacker(const BoardC board,
+                                             const Position pos,
+                                             const enum Player player,
+                                             const int16_t* values) {
+  const int8_t sign = player == PLAYER_RED ? 1 : -1;
+  Position best = K_NO_POSITION;
+  int16_t best_value = INT16_MAX;
+  for (uint8_t d = 0; d < K_TOTAL_DIRECTIONS; d++) {
+    const Position* ray = K_SQUARE_TABLES.rays[pos][d];
+    if (*ray == K_NO_POSITION) {
+      continue;
+    }
+    const enum Piece adjacent = board[*ray];
+    if ((adjacent == sign * R_SOLDIER &&
+         StepsHave(&K_LEAPER_TABLES.soldier[player][*ray], pos)) ||
+        (adjacent == sign * R_GENERAL &&
+         StepsHave(&K_LEAPER_TABLES.general[player][*ray], pos))) {
+      KeepCheaper(board, values, *ray, &best, &best_value);
+    }
+    while (*ray != K_NO_POSITION && IsEmpty(board[*ray])) {
+      ray++;
+    }
+    if (*ray == K_NO_POSITION) {
+      continue;
+    }
+    const enum Piece first = board[*ray];
+    if (first == sign * R_CHARIOT ||
+        (first == sign * R_GENERAL && board[pos] == -sign * R_GENERAL)) {
+      KeepCheaper(board, values, *ray, &best, &best_value);
+    }
+    for (ray++; *ray != K_NO_POSITION; ray++) {
+      if (!IsEmpty(board[*ray])) {
+        if (board[*ray] == sign * R_CANNON) {
+          KeepCheaper(board, values, *ray, &best, &best_value);
+        }
+        break;
+      }
+    }
+  }
+  for (const Position* diagonal = K_SQUARE_TABLES.diagonals[pos];
+       *diagonal != K_NO_POSITION; diagonal++) {
+    if (board[*diagonal] == sign * R_ADVISOR &&
+        StepsHave(&K_LEAPER_TABLES.advisor[player][*diagonal], pos)) {
+      KeepCheaper(board, values, *diagonal, &best, &best_value);
+    }
+  }
+  const ElephantLeapsC* elephant = &K_LEAPER_TABLES.elephant[player][pos];
+  for (uint8_t i = 0; i < elephant->count; i++) {
+    const LeapC leap = elephant->leaps[i];
+    if (board[leap.dest] == sign * R_ELEPHANT && IsEmpty(board[leap.block])) {
+      KeepCheaper(board, values, leap.dest, &best, &best_value);
+    }
+  }
+  const HorseLeapsC* horse = &K_LEAPER_TABLES.horse[pos];
+  for (uint8_t i = 0; i < horse->count; i++) {
+    const Position from = horse->leaps[i].dest;
+    if (board[from] == sign * R_HORSE && ThreatensByHorse(board, from, pos)) {
+      KeepCheaper(board, values, from, &best, &best_value);
+    }
+  }
+  return best;
+}
+
+// Adds one to counts[dest] for every position the piece at pos could capture
+// on, in the same sense as PlayerAttacks.
+static inline void AddPieceAttacks(const BoardC board, const Position pos,
+                                   uint8_t* counts) {
+  const enum Piece piece = board[pos];
+  const enum Player player = IsRed(piece) ? PLAYER_RED : PLAYER_BLACK;
+  switch (piece > 0 ? piece : -piece) {
+    case R_CHARIOT:
+    case R_CANNON: {
+      const bool is_cannon = piece == R_CANNON || piece == B_CANNON;
+      for (uint8_t d = 0; d < K_TOTAL_DIRECTIONS; d++) {
+        const Position* ray = K_SQUARE_TABLES.rays[pos][d];
+        if (is_cannon) {
+          while (*ray != K_NO_POSITION && IsEmpty(board[*ray])) {
+            ray++;
+          }
+          if (*ray == K_NO_POSITION) {
+            continue;
+          }
+          ray++;
+        }
+        for (; *ray != K_NO_POSITION; ray++) {
+          counts[*ray]++;
+          if (!IsEmpty(board[*ray])) {
+            break;
+          }
+        }
+      }
+      return;
+    }
+    case R_GENERAL: {
+      const StepsC* steps = &K_LEAPER_TABLES.general[player][pos];
+      for (uint8_t i = 0; i < steps->count; i++) {
+        counts[steps->dests[i]]++;
+      }
+      for (uint8_t d = 0; d < K_TOTAL_DIRECTIONS; d++) {
+        const Position* ray = K_SQUARE_TABLES.rays[pos][d];
+        while (*ray != K_NO_POSITION && IsEmpty(board[*ray])) {
+          ray++;
+        }
+        if (*ray != K_NO_POSITION && board[*ray] == -piece) {
+          counts[*ray]++;
+        }
+      }
+      return;
+    }
+    case R_ADVISOR:
+    case R_SOLDIER: {
+      const StepsC* steps = piece == R_ADVISOR || piece == B_ADVISOR
+                                ? &K_LEAPER_TABLES.advisor[player][pos]
+                                : &K_LEAPER_TABLES.soldier[player][pos];
+      for (uint8_t i = 0; i < steps->count; i++) {
+        counts[steps->dests[i]]++;
+      }
+      return;
+    }
+    case R_ELEPHANT: {
+      const ElephantLeapsC* leaps = &K_LEAPER_TABLES.elephant[player][pos];
+      for (uint8_t i = 0; i < leaps->count; i++) {
+        if (IsEmpty(board[leaps->leaps[i].block])) {
+          counts[leaps->leaps[i].dest]++;
+        }
+      }
+      return;
+    }
+    case R_HORSE: {
+      const HorseLeapsC* leaps = &K_LEAPER_TABLES.horse[pos];
+      for (uint8_t i = 0; i < leaps->count; i++) {
+        if (IsEmpty(board[leaps->leaps[i].block])) {
+          counts[leaps->leaps[i].dest]++;
+        }
+      }
+      return;
+    }
+    default:
+      return;
+  }
+}
+
+// Squares that decide whether a pseudo-legal move can expose a player's
+// general, computed once per position so that only the few moves touching
+// them need to be verified by making the move.
+//
+// A move that does not move the general can only expose it by:
+//  - vacating one of the first two pieces on one of the general's rank or file
+//    directions, which may unblock a chariot or the flying general, or leave
+//    a cannon with a single screen,
+//  - vacating a position diagonally adjacent to the general, which may be the
+//    leg of a horse,
+//  - occupying an empty position between the general and the first piece in
+//    some direction, which may become the screen of a cannon.
+// Capturing never exposes the general since the captured position stays
+// occupied, and soldiers cannot be blocked.
+typedef struct {
+  Position general;
+  // If in check, every move is verified.
+  bool in_check;
+  BitboardC risky_from;
+  BitboardC risky_to;
+} CheckInfoC;
+
+static inline void ComputeCheckInfo(const BoardC board,
+                                    const Position general,
+                                    const bool in_check, CheckInfoC* out) {
+  out->general = general;
+  out->in_check = in_check || general == K_NO_POSITION;
+  out->risky_from = K_EMPTY_BITBOARD;
+  out->risky_to = K_EMPTY_BITBOARD;
+  if (out->in_check) {
+    return;
+  }
+  for (uint8_t d = 0; d < K_TOTAL_DIRECTIONS; d++) {
+    const Position* ray = K_SQUARE_TABLES.rays[general][d];
+    uint8_t pieces_found = 0;
+    for (; *ray != K_NO_POSITION && pieces_found < 2; ray++) {
+      if (IsEmpty(board[*ray])) {
+        if (pieces_found == 0) {
+          out->risky_to |= BitboardOf(*ray);
+        }
+      } else {
+        out->risky_from |= BitboardOf(*ray);
+        pieces_found++;
+      }
+    }
+  }
+  for (const Position* diagonal = K_SQUARE_TABLES.diagonals[general];
+       *diagonal != K_NO_POSITION; diagonal++) {
+    out->risky_from |= BitboardOf(*diagonal);
+  }
+}
+
+// Returns true if the move must be made to find out whether it exposes the
+// general.
+static inline bool NeedsVerification(const CheckInfoC* info,
+                                     const Position from, const Position to) {
+  return info->in_check || from == info->general ||
+         BitboardHas(info->risky_from, from) ||
+         BitboardHas(info->risky_to, to);
+}
+
+// Adds the positions that can resolve a check by the opponent's piece at
+// checker. A non-general move can only get out of the check by moving to a
+// position in to (capturing the checker, blocking its line or its horse leg,
+// or adding a second cannon screen), or by moving a cannon screen away from a
+// position in from.
+static inline void AddEvasionTargets(const BoardC board, const Position general,
+                                     const Position checker, BitboardC* to,
+                                     BitboardC* from) {
+  *to |= BitboardOf(checker);
+  const enum Piece piece = board[checker];
+  switch (piece > 0 ? piece : -piece) {
+    case R_GENERAL:
+    case R_CHARIOT:
+    case R_CANNON: {
+      const int8_t unit = Row(checker) == Row(general) ? 1 : K_TOTAL_COL;
+      const int8_t step = checker < general ? unit : -unit;
+      for (Position pos = checker + step; pos != general; pos += step) {
+        if (IsEmpty(board[pos])) {
+          *to |= BitboardOf(pos);
+        } else {
+          *from |= BitboardOf(pos);
+        }
+      }
+      break;
+    }
+    case R_HORSE: {
+      const HorseLeapsC* leaps = &K_LEAPER_TABLES.horse[checker];
+      for (uint8_t i = 0; i < leaps->count; i++) {
+        if (leaps->leaps[i].dest == general) {
+          *to |= BitboardOf(leaps->leaps[i].block);
+        }
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_INTERNAL_MOVE_GEN_C_H_
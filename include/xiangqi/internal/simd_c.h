@@ -0,0 +1,292 @@
+#ifndef XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_INTERNAL_SIMD_C_H_
+#define XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_INTERNAL_SIMD_C_H_
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "xiangqi/bitboard_c.h"
+#include "xiangqi/types_c.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Vector kernels for scans and transforms of a whole board. The widest
+// instruction set enabled at compile time is used (AVX2, SSSE3 or SSE2), scans
+// fall back to scalar code otherwise. Loads never read past the end of
+// a board, the last chunk is loaded from the end of the board instead and
+// overlaps the previous one.
+
+#define K_BOARD_BITBOARD (BitboardOf(K_BOARD_SIZE) - 1)
+
+#if defined(__SSE2__)
+static inline uint32_t MatchMask16(const enum Piece* start,
+                                   const __m128i target) {
+  const __m128i chunk = _mm_loadu_si128((const __m128i*)start);
+  return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, target));
+}
+#endif
+
+#if defined(__AVX2__)
+static inline uint32_t MatchMask32(const enum Piece* start,
+                                   const __m256i target) {
+  const __m256i chunk = _mm256_loadu_si256((const __m256i*)start);
+  return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, target));
+}
+#endif
+
+// Returns the positions of the 32 pieces from start holding piece, bit i is
+// set if start[i] matches.
+static inline uint32_t ChunkMatchMask(const enum Piece* start,
+                                      const enum Piece piece) {
+#if defined(__AVX2__)
+  return MatchMask32(start, _mm256_set1_epi8((char)piece));
+#elif defined(__SSE2__)
+  const __m128i target = _mm_set1_epi8((char)piece);
+  return MatchMask16(start, target) | (MatchMask16(start + 16, target) << 16);
+#else
+  uint32_t res = 0;
+  for (uint8_t i = 0; i < 32; i++) {
+    res |= (uint32_t)(start[i] == piece) << i;
+  }
+  return res;
+#endif
+}
+
+#if defined(__SSE2__)
+// Bit i is set if start[i] is a red piece, or a black piece if red is false.
+static inline uint32_t SideMask16(const enum Piece* start, const bool red) {
+  const __m128i chunk = _mm_loadu_si128((const __m128i*)start);
+  const __m128i zero = _mm_setzero_si128();
+  return (uint32_t)_mm_movemask_epi8(red ? _mm_cmpgt_epi8(chunk, zero)
+                                         : _mm_cmpgt_epi8(zero, chunk));
+}
+#endif
+
+#if defined(__AVX2__)
+static inline uint32_t SideMask32(const enum Piece* start, const bool red) {
+  const __m256i chunk = _mm256_loadu_si256((const __m256i*)start);
+  const __m256i zero = _mm256_setzero_si256();
+  return (uint32_t)_mm256_movemask_epi8(red ? _mm256_cmpgt_epi8(chunk, zero)
+                                            : _mm256_cmpgt_epi8(zero, chunk));
+}
+#endif
+
+// Returns the positions on board holding piece.
+static inline BitboardC BoardMatchMask(const BoardC board,
+                                       const enum Piece piece) {
+#if defined(__AVX2__)
+  const __m256i target = _mm256_set1_epi8((char)piece);
+  // The last chunk covers [58, 90).
+  const uint64_t low = (uint64_t)MatchMask32(board, target) |
+                       ((uint64_t)MatchMask32(board + 32, target) << 32);
+  const uint64_t high = MatchMask32(board + K_BOARD_SIZE - 32, target) >> 6;
+  return (BitboardC)low | ((BitboardC)high << 64);
+#elif defined(__SSE2__)
+  const __m128i target = _mm_set1_epi8((char)piece);
+  // The last chunk covers [74, 90).
+  const uint64_t low = (uint64_t)MatchMask16(board, target) |
+                       ((uint64_t)MatchMask16(board + 16, target) << 16) |
+                       ((uint64_t)MatchMask16(board + 32, target) << 32) |
+                       ((uint64_t)MatchMask16(board + 48, target) << 48);
+  const uint64_t high =
+      MatchMask16(board + 64, target) |
+      ((MatchMask16(board + K_BOARD_SIZE - 16, target) >> 6) << 16);
+  return (BitboardC)low | ((BitboardC)high << 64);
+#else
+  BitboardC res = K_EMPTY_BITBOARD;
+  for (Position pos = 0; pos < K_BOARD_SIZE; pos++) {
+    res |= (BitboardC)(board[pos] == piece) << pos;
+  }
+  return res;
+#endif
+}
+
+// Returns the positions on board holding a piece of player.
+static inline BitboardC BoardPlayerMask(const BoardC board,
+                                        const enum Player player) {
+  const bool red = player == PLAYER_RED;
+#if defined(__AVX2__)
+  // The last chunk covers [58, 90).
+  const uint64_t low = (uint64_t)SideMask32(board, red) |
+                       ((uint64_t)SideMask32(board + 32, red) << 32);
+  const uint64_t high = SideMask32(board + K_BOARD_SIZE - 32, red) >> 6;
+  return (BitboardC)low | ((BitboardC)high << 64);
+#elif defined(__SSE2__)
+  // The last chunk covers [74, 90).
+  const uint64_t low = (uint64_t)SideMask16(board, red) |
+                       ((uint64_t)SideMask16(board + 16, red) << 16) |
+                       ((uint64_t)SideMask16(board + 32, red) << 32) |
+                       ((uint64_t)SideMask16(board + 48, red) << 48);
+  const uint64_t high = SideMask16(board + 64, red) |
+                        ((SideMask16(board + K_BOARD_SIZE - 16, red) >> 6)
+                         << 16);
+  return (BitboardC)low | ((BitboardC)high << 64);
+#else
+  BitboardC res = K_EMPTY_BITBOARD;
+  for (Position pos = 0; pos < K_BOARD_SIZE; pos++) {
+    res |= (BitboardC)(red ? board[pos] > 0 : board[pos] < 0) << pos;
+  }
+  return res;
+#endif
+}
+
+// Returns the occupied positions on board.
+static inline BitboardC BoardOccupancyMask(const BoardC board) {
+  return ~BoardMatchMask(board, PIECE_EMPTY) & K_BOARD_BITBOARD;
+}
+
+// Returns the columns of row holding piece, bit i is set if the i-th column
+// matches.
+static inline uint16_t RowMatchMask(const BoardC board, const uint8_t row,
+                                    const enum Piece piece) {
+  const Position start = row * K_TOTAL_COL;
+#if defined(__SSE2__)
+  // Rows near the end of the board are loaded from an earlier position.
+  const Position offset =
+      start < K_BOARD_SIZE - 16 ? start : K_BOARD_SIZE - 16;
+  const uint32_t mask = MatchMask16(board + offset, _mm_set1_epi8((char)piece));
+  return (uint16_t)((mask >> (start - offset)) & ((1 << K_TOTAL_COL) - 1));
+#else
+  uint16_t res = 0;
+  for (uint8_t col = 0; col < K_TOTAL_COL; col++) {
+    res |= (uint16_t)(board[start + col] == piece) << col;
+  }
+  return res;
+#endif
+}
+
+// Returns true if both boards have the same piece at every position.
+static inline bool BoardsEqual(const BoardC a, const BoardC b) {
+#if defined(__AVX2__)
+  __m256i eq = _mm256_set1_epi8(-1);
+  for (Position pos = 0; pos < K_BOARD_SIZE - 32; pos += 32) {
+    eq = _mm256_and_si256(
+        eq, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(a + pos)),
+                              _mm256_loadu_si256((const __m256i*)(b + pos))));
+  }
+  const Position last = K_BOARD_SIZE - 32;
+  eq = _mm256_and_si256(
+      eq, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(a + last)),
+                            _mm256_loadu_si256((const __m256i*)(b + last))));
+  return (uint32_t)_mm256_movemask_epi8(eq) == 0xFFFFFFFF;
+#elif defined(__SSE2__)
+  __m128i eq = _mm_set1_epi8(-1);
+  for (Position pos = 0; pos < K_BOARD_SIZE - 16; pos += 16) {
+    eq = _mm_and_si128(
+        eq, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + pos)),
+                           _mm_loadu_si128((const __m128i*)(b + pos))));
+  }
+  const Position last = K_BOARD_SIZE - 16;
+  eq = _mm_and_si128(
+      eq, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + last)),
+                         _mm_loadu_si128((const __m128i*)(b + last))));
+  return _mm_movemask_epi8(eq) == 0xFFFF;
+#else
+  return memcmp(a, b, sizeof(BoardC)) == 0;
+#endif
+}
+
+#if defined(__SSSE3__)
+
+// Two consecutive rows, the unit of the board transforms below.
+#define K_ROW_PAIR_SIZE (2 * K_TOTAL_COL)
+
+// A board transform that maps each pair of rows (0-1, 2-3, ...) to one pair
+// of rows of the result, e.g. flipping and mirroring.
+typedef struct {
+  // Result row pair i comes from source row pair K_TOTAL_ROW / 2 - 1 - i if
+  // true, otherwise from source row pair i.
+  bool reverse_pairs;
+  // Whether red and black pieces are swapped.
+  bool negate;
+  // Byte shuffles from a source row pair to a result row pair. A row pair is
+  // loaded as two overlapping 16-byte chunks a = [0, 16) and b = [2, 18), and
+  // stored the same way. shuffle[0] and shuffle[1] pick bytes from a and b for
+  // the first chunk of the result, shuffle[2] and shuffle[3] for the second.
+  // 0x80 zeros a byte.
+  uint8_t shuffle[4][16];
+} RowPairTransformC;
+
+static const RowPairTransformC K_FLIP_TRANSFORM = {
+    true,
+    true,
+    {{0x80, 0x80, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2},
+     {15, 14, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+      0x80, 0x80, 0x80},
+     {15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0},
+     {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+      0x80, 0x80, 0x80, 0x80}},
+};
+
+static const RowPairTransformC K_MIRROR_HORIZONTAL_TRANSFORM = {
+    false,
+    false,
+    {{8, 7, 6, 5, 4, 3, 2, 1, 0, 0x80, 0x80, 15, 14, 13, 12, 11},
+     {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 15, 14, 0x80, 0x80,
+      0x80, 0x80, 0x80},
+     {6, 5, 4, 3, 2, 1, 0, 0x80, 0x80, 15, 14, 13, 12, 11, 10, 9},
+     {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 15, 14, 0x80, 0x80, 0x80, 0x80,
+      0x80, 0x80, 0x80}},
+};
+
+static const RowPairTransformC K_MIRROR_VERTICAL_TRANSFORM = {
+    true,
+    true,
+    {{9, 10, 11, 12, 13, 14, 15, 0x80, 0x80, 0, 1, 2, 3, 4, 5, 6},
+     {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 14, 15, 0x80, 0x80, 0x80, 0x80,
+      0x80, 0x80, 0x80},
+     {11, 12, 13, 14, 15, 0x80, 0x80, 0, 1, 2, 3, 4, 5, 6, 7, 8},
+     {0x80, 0x80, 0x80, 0x80, 0x80, 14, 15, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+      0x80, 0x80, 0x80}},
+};
+
+// Applies transform to src and writes the result to dest, dest may be src.
+// Only available with SSSE3, callers keep their own scalar version.
+static inline void TransformBoard(BoardC dest, const BoardC src,
+                                  const RowPairTransformC* transform) {
+  const uint8_t num_pairs = K_TOTAL_ROW / 2;
+  const __m128i shuffle_0 =
+      _mm_loadu_si128((const __m128i*)transform->shuffle[0]);
+  const __m128i shuffle_1 =
+      _mm_loadu_si128((const __m128i*)transform->shuffle[1]);
+  const __m128i shuffle_2 =
+      _mm_loadu_si128((const __m128i*)transform->shuffle[2]);
+  const __m128i shuffle_3 =
+      _mm_loadu_si128((const __m128i*)transform->shuffle[3]);
+  const __m128i zero = _mm_setzero_si128();
+  // Everything is loaded before the first store so that dest may alias src.
+  __m128i first[K_TOTAL_ROW / 2];
+  __m128i second[K_TOTAL_ROW / 2];
+  for (uint8_t pair = 0; pair < num_pairs; pair++) {
+    const uint8_t src_pair =
+        transform->reverse_pairs ? num_pairs - 1 - pair : pair;
+    const enum Piece* start = src + src_pair * K_ROW_PAIR_SIZE;
+    const __m128i a = _mm_loadu_si128((const __m128i*)start);
+    const __m128i b = _mm_loadu_si128((const __m128i*)(start + 2));
+    first[pair] = _mm_or_si128(_mm_shuffle_epi8(a, shuffle_0),
+                               _mm_shuffle_epi8(b, shuffle_1));
+    second[pair] = _mm_or_si128(_mm_shuffle_epi8(a, shuffle_2),
+                                _mm_shuffle_epi8(b, shuffle_3));
+    if (transform->negate) {
+      first[pair] = _mm_sub_epi8(zero, first[pair]);
+      second[pair] = _mm_sub_epi8(zero, second[pair]);
+    }
+  }
+  for (uint8_t pair = 0; pair < num_pairs; pair++) {
+    enum Piece* start = dest + pair * K_ROW_PAIR_SIZE;
+    _mm_storeu_si128((__m128i*)start, first[pair]);
+    _mm_storeu_si128((__m128i*)(start + 2), second[pair]);
+  }
+}
+
+#endif  // defined(__SSSE3__)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_INTERNAL_SIMD_C_H_
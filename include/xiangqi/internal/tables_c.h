@@ -0,0 +1,160 @@
+#ifndef XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_INTERNAL_TABLES_C_H_
+#define XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_INTERNAL_TABLES_C_H_
+
+#include "xiangqi/bitboard_c.h"
+#include "xiangqi/internal/simd_c.h"
+#include "xiangqi/types_c.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Precomputed move geometry shared by the move generators. All tables are
+// generated by constexpr functions in lib/xiangqi/internal/tables.cc, so they
+// live in read-only data and cost nothing at startup.
+
+// A leaping move to dest, which is illegal if block is occupied.
+typedef struct {
+  Position dest;
+  Position block;
+} LeapC;
+
+// Horse moves from a position, leaps[0, count) are valid.
+typedef struct {
+  uint8_t count;
+  LeapC leaps[8];
+} HorseLeapsC;
+
+// Elephant moves from a position, leaps[0, count) are valid.
+typedef struct {
+  uint8_t count;
+  LeapC leaps[4];
+} ElephantLeapsC;
+
+// Single step moves that can never be blocked, dests[0, count) are valid.
+typedef struct {
+  uint8_t count;
+  Position dests[4];
+} StepsC;
+
+// Tables of pieces whose moves have a fixed shape. Tables that depend on the
+// side are indexed by Player first, then by the position of the piece.
+// Positions a piece can never stand on (e.g. an advisor outside of its
+// palace) have no moves.
+typedef struct {
+  HorseLeapsC horse[K_BOARD_SIZE];
+  ElephantLeapsC elephant[2][K_BOARD_SIZE];
+  StepsC advisor[2][K_BOARD_SIZE];
+  // Moves inside the palace only, the flying general is not included.
+  StepsC general[2][K_BOARD_SIZE];
+  StepsC soldier[2][K_BOARD_SIZE];
+} LeaperTablesC;
+
+extern const LeaperTablesC K_LEAPER_TABLES;
+
+// Targets of a chariot and a cannon along one rank or file, as bit masks over
+// the positions of that line.
+typedef struct {
+  // Empty positions in both directions, plus the first piece in each
+  // direction (may be either player's).
+  uint16_t chariot;
+  // Empty positions in both directions before the screen, plus the first piece
+  // behind the screen in each direction (may be either player's).
+  uint16_t cannon;
+} SlideC;
+
+// Tables of sliding pieces, indexed by the position of the piece within the
+// line, then by the occupancy of the line. Bit i of a rank occupancy is set if
+// the i-th column of that rank is occupied, bit i of a file occupancy is set
+// if the i-th row of that file is occupied.
+typedef struct {
+  SlideC rank[K_TOTAL_COL][1 << K_TOTAL_COL];
+  SlideC file[K_TOTAL_ROW][1 << K_TOTAL_ROW];
+} SliderTablesC;
+
+extern const SliderTablesC K_SLIDER_TABLES;
+
+// Orthogonal directions from a position, used to index rays.
+#define K_TOTAL_DIRECTIONS 4
+
+// Longest ray, a full file minus the starting position, plus the sentinel.
+#define K_MAX_RAY_SIZE K_TOTAL_ROW
+
+// Lines walked from every position. Walks follow rays that end with the
+// sentinel K_NO_POSITION instead of checking rows and columns at every step,
+// like a mailbox padded with off-board squares, while BoardC keeps its
+// 90-position layout.
+typedef struct {
+  // Positions up, down, left and right of each position, nearest first, each
+  // ray ends with K_NO_POSITION.
+  Position rays[K_BOARD_SIZE][K_TOTAL_DIRECTIONS][K_MAX_RAY_SIZE];
+  // Diagonally adjacent positions, ends with K_NO_POSITION.
+  Position diagonals[K_BOARD_SIZE][5];
+} SquareTablesC;
+
+extern const SquareTablesC K_SQUARE_TABLES;
+
+// Number of distinct values of Piece, including PIECE_EMPTY.
+#define K_TOTAL_PIECE_VALUES 15
+
+// Random keys for Zobrist hashing. pieces is indexed by Piece + R_SOLDIER so
+// that black pieces come first, keys of PIECE_EMPTY are zero.
+typedef struct {
+  uint64_t pieces[K_TOTAL_PIECE_VALUES][K_BOARD_SIZE];
+  // Toggled when black is the player to move.
+  uint64_t black_to_move;
+} ZobristTablesC;
+
+extern const ZobristTablesC K_ZOBRIST_TABLES;
+
+static inline uint64_t ZobristPieceKey(const enum Piece piece,
+                                       const Position pos) {
+  return K_ZOBRIST_TABLES.pieces[piece + R_SOLDIER][pos];
+}
+
+// Occupancy of every rank and file of a board, used to index
+// K_SLIDER_TABLES.
+typedef struct {
+  uint16_t ranks[K_TOTAL_ROW];
+  uint16_t files[K_TOTAL_COL];
+} LineOccupancyC;
+
+// Splits the occupied positions of a board into ranks and files.
+static inline void SplitLineOccupancy(const BitboardC occupancy,
+                                      LineOccupancyC* out) {
+  for (uint8_t col = 0; col < K_TOTAL_COL; col++) {
+    out->files[col] = 0;
+  }
+  for (uint8_t row = 0; row < K_TOTAL_ROW; row++) {
+    const uint16_t rank =
+        (uint16_t)(occupancy >> (row * K_TOTAL_COL)) & ((1 << K_TOTAL_COL) - 1);
+    out->ranks[row] = rank;
+    for (uint8_t col = 0; col < K_TOTAL_COL; col++) {
+      out->files[col] |= ((rank >> col) & 1) << row;
+    }
+  }
+}
+
+static inline void ComputeLineOccupancy(const BoardC board,
+                                        LineOccupancyC* out) {
+  SplitLineOccupancy(BoardOccupancyMask(board), out);
+}
+
+static inline uint16_t RankOccupancy(const BoardC board, const uint8_t row) {
+  return ~RowMatchMask(board, row, PIECE_EMPTY) & ((1 << K_TOTAL_COL) - 1);
+}
+
+// Positions of a file are not contiguous, so this stays a scalar gather.
+static inline uint16_t FileOccupancy(const BoardC board, const uint8_t col) {
+  uint16_t res = 0;
+  for (uint8_t row = 0; row < K_TOTAL_ROW; row++) {
+    res |= (uint16_t)(board[row * K_TOTAL_COL + col] != PIECE_EMPTY) << row;
+  }
+  return res;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_INTERNAL_TABLES_C_H_
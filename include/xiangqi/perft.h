@@ -0,0 +1,44 @@
+#ifndef XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_PERFT_H_
+#define XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_PERFT_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "xiangqi/perft_c.h"
+#include "xiangqi/tracked_board.h"
+#include "xiangqi/types.h"
+
+namespace xq {
+
+// C++ wrapper of Perft_C.
+uint64_t Perft(const Board& board, Player player, uint8_t depth);
+
+// C++ wrapper of PerftDivide_C, pairs of root move and number of leaf nodes
+// below it.
+std::vector<std::pair<Movement, uint64_t>> PerftDivide(const Board& board,
+                                                       Player player,
+                                                       uint8_t depth);
+
+// C++ wrapper of TrackedPerft_C.
+uint64_t TrackedPerft(const TrackedBoard& tracked, Player player,
+                      uint8_t depth);
+
+// Same as PerftDivide, counted by num_threads threads (0 for one per hardware
+// thread). The tree is split into subtrees of the root moves (or of the
+// replies to them, if there are too few root moves to keep every thread busy),
+// which idle threads steal from each other. Counts of subtrees are cached in
+// a lock-free hash table of hash_size_mb megabytes shared by all threads,
+// keyed by Zobrist key and depth, 0 disables the cache. Like every
+// Zobrist-keyed cache, a 64-bit key collision could make a count wrong.
+std::vector<std::pair<Movement, uint64_t>> ParallelPerftDivide(
+    const Board& board, Player player, uint8_t depth,
+    unsigned num_threads = 0, size_t hash_size_mb = 64);
+
+// Sum of ParallelPerftDivide, same as Perft.
+uint64_t ParallelPerft(const Board& board, Player player, uint8_t depth,
+                       unsigned num_threads = 0, size_t hash_size_mb = 64);
+
+}  // namespace xq
+
+#endif  // XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_PERFT_H_
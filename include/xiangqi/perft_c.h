@@ -0,0 +1,34 @@
+#ifndef XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_PERFT_C_H_
+#define XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_PERFT_C_H_
+
+#include "xiangqi/board_c.h"
+#include "xiangqi/tracked_board_c.h"
+#include "xiangqi/types_c.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Performance test of move generation: counts the leaf nodes of the tree of
+// legal moves (PossibleMoves_C with avoid_checkmate) that is depth plies deep,
+// starting from board with player to move. Depth 0 counts board itself.
+// Known counts from the starting board are 44, 1920, 79666 and 3290240 for
+// depth 1 to 4.
+uint64_t Perft_C(const BoardC board, enum Player player, uint8_t depth);
+
+// Same as Perft_C, split by root move. moves_out[i] is a legal move of player
+// and counts_out[i] is the number of leaf nodes below it, so the counts add
+// up to Perft_C. Depth must be at least 1. Returns number of root moves.
+uint8_t PerftDivide_C(const BoardC board, enum Player player, uint8_t depth,
+                      MaxMovesPerPlayerC moves_out,
+                      uint64_t counts_out[K_MAX_MOVE_PER_PLAYER]);
+
+// Same as Perft_C, using the piece list move generator.
+uint64_t TrackedPerft_C(const TrackedBoardC* tracked, enum Player player,
+                        uint8_t depth);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_PERFT_C_H_
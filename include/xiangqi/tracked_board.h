@@ -0,0 +1,40 @@
+#ifndef XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_TRACKED_BOARD_H_
+#define XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_TRACKED_BOARD_H_
+
+#include <vector>
+
+#include "xiangqi/board.h"
+#include "xiangqi/tracked_board_c.h"
+#include "xiangqi/types.h"
+
+namespace xq {
+
+using TrackedBoard = TrackedBoardC;
+
+// C++ wrapper of TrackBoard_C.
+TrackedBoard TrackBoard(const Board& board);
+
+// C++ wrapper of TrackedMove_C.
+Piece TrackedMove(TrackedBoard& tracked, Movement movement);
+
+// C++ wrapper of TrackedMakeMove_C.
+Piece TrackedMakeMove(TrackedBoard& tracked, Movement movement,
+                      MoveUndo& undo);
+
+// C++ wrapper of TrackedUnmakeMove_C.
+void TrackedUnmakeMove(TrackedBoard& tracked, const MoveUndo& undo);
+
+// C++ wrapper of TrackedIsBeingCheckmate_C.
+bool TrackedIsBeingCheckmate(const TrackedBoard& tracked, Player player);
+
+// C++ wrapper of TrackedPossibleMoves_C.
+std::vector<Movement> TrackedPossibleMoves(const TrackedBoard& tracked,
+                                           Player player,
+                                           bool avoid_checkmate = false);
+
+// C++ wrapper of TrackedDidPlayerLose_C.
+bool TrackedDidPlayerLose(const TrackedBoard& tracked, Player player);
+
+}  // namespace xq
+
+#endif  // XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_TRACKED_BOARD_H_
@@ -0,0 +1,71 @@
+#ifndef XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_TRACKED_BOARD_C_H_
+#define XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_TRACKED_BOARD_C_H_
+
+#include "xiangqi/board_c.h"
+#include "xiangqi/types_c.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define K_MAX_PIECES_PER_PLAYER 16
+
+// Mailbox board with per-player piece lists, so that move generation and
+// check detection only visit live pieces instead of scanning all positions.
+// All fields are kept in sync by TrackedMove_C, TrackedMakeMove_C and
+// TrackedUnmakeMove_C, do not modify them directly.
+typedef struct {
+  BoardC board;
+  // Position of each player's general, K_NO_POSITION if it was captured.
+  // Indexed by Player.
+  Position general[2];
+  // Number of pieces of each player, indexed by Player.
+  uint8_t count[2];
+  // Positions of each player's pieces in no particular order,
+  // pieces[player][0, count[player]) are valid.
+  Position pieces[2][K_MAX_PIECES_PER_PLAYER];
+  // Index into the owner's piece list of the piece at each position,
+  // K_NO_PIECE_INDEX if the position is empty.
+  uint8_t index[K_BOARD_SIZE];
+} TrackedBoardC;
+
+// Builds piece lists for a board. Each player may have at most
+// K_MAX_PIECES_PER_PLAYER pieces, and at most one general.
+void TrackBoard_C(const BoardC board, TrackedBoardC* out);
+
+// Same as FindGeneral_C, without scanning the board.
+static inline Position TrackedFindGeneral_C(const TrackedBoardC* tracked,
+                                            const enum Player player) {
+  return tracked->general[player];
+}
+
+// Same as Move_C, also updates the piece lists.
+enum Piece TrackedMove_C(TrackedBoardC* tracked, Movement movement);
+
+// Same as MakeMove_C, also updates the piece lists.
+enum Piece TrackedMakeMove_C(TrackedBoardC* tracked, Movement movement,
+                             MoveUndoC* undo);
+
+// Takes back a move made by TrackedMakeMove_C, restoring the piece lists in
+// their original order. Moves must be taken back in the reverse order they
+// were made.
+void TrackedUnmakeMove_C(TrackedBoardC* tracked, const MoveUndoC* undo);
+
+// Same as IsBeingCheckmate_C, only visits the opponent's pieces.
+bool TrackedIsBeingCheckmate_C(const TrackedBoardC* tracked,
+                               enum Player player);
+
+// Same as PossibleMoves_C, only visits the player's pieces. Produces the same
+// set of moves, ordering may differ.
+uint8_t TrackedPossibleMoves_C(const TrackedBoardC* tracked,
+                               enum Player player, bool avoid_checkmate,
+                               MaxMovesPerPlayerC out);
+
+// Same as DidPlayerLose_C, only visits live pieces.
+bool TrackedDidPlayerLose_C(const TrackedBoardC* tracked, enum Player player);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_TRACKED_BOARD_C_H_
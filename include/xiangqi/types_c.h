@@ -111,6 +111,16 @@ static inline Position Dest(const Movement movement) {
   return movement & 0x00FF;
 }
 
+// Same move on the board mirrored by MirrorPositionHorizontal,
+// K_NO_MOVEMENT stays unchanged.
+static inline Movement MirrorMovementHorizontal(const Movement movement) {
+  if (movement == K_NO_MOVEMENT) {
+    return movement;
+  }
+  return NewMovement(MirrorPositionHorizontal(Orig(movement)),
+                     MirrorPositionHorizontal(Dest(movement)));
+}
+
 #ifdef __cplusplus
 }
 #endif
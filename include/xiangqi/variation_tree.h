@@ -0,0 +1,110 @@
+#ifndef XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_VARIATION_TREE_H__
+#define XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_VARIATION_TREE_H__
+
+#include <cstdint>
+#include <vector>
+
+#include "xiangqi/board.h"
+#include "xiangqi/types.h"
+
+namespace xq {
+
+// Index of a node in VariationTree. Nodes are never removed, so an index stays
+// valid for the lifetime of the tree.
+using VariationNode = uint32_t;
+
+// Tree of lines played from one starting position. Every node is a single
+// move, lines that share a prefix share its nodes. Only the board of the
+// current node is kept, other nodes are reached by taking back and replaying
+// the moves between them.
+class VariationTree {
+ public:
+  // The starting position, before any move.
+  static constexpr VariationNode kRoot = 0;
+  static constexpr VariationNode kNoNode = UINT32_MAX;
+
+  // Starts a tree from board with player to move.
+  explicit VariationTree(const Board& board = kStartingBoard,
+                         Player player = PLAYER_RED);
+  ~VariationTree() = default;
+
+  // Node of the current position.
+  VariationNode Current() const;
+
+  // Board of the current position.
+  const Board& CurrentBoard() const;
+
+  // Player to move in the current position.
+  Player CurrentPlayer() const;
+
+  // Same as ZobristKey(CurrentBoard(), CurrentPlayer()).
+  uint64_t Key() const;
+
+  // Makes move from the current position and returns its node. If the move
+  // was already played from here, its existing node is reused.
+  VariationNode Move(Movement move);
+
+  // Goes back to the parent of the current node. Returns false at the root.
+  bool Back();
+
+  // Goes to node, taking back moves up to the closest common ancestor and
+  // replaying the moves down from it. Returns false and does nothing if node
+  // does not exist.
+  bool GoTo(VariationNode node);
+
+  // Makes node the first child of its parent, so it becomes the main line.
+  void PromoteVariation(VariationNode node);
+
+  // Number of nodes, including the root.
+  size_t NodesCount() const;
+
+  // Tree structure. kNoNode if there is no such node.
+  VariationNode Parent(VariationNode node) const;
+  VariationNode FirstChild(VariationNode node) const;
+  VariationNode NextSibling(VariationNode node) const;
+
+  // Child of node reached by move, or kNoNode.
+  VariationNode FindChild(VariationNode node, Movement move) const;
+
+  // Children of node, the main line first.
+  std::vector<VariationNode> Children(VariationNode node) const;
+
+  // Move that leads to node. K_NO_MOVEMENT for the root.
+  Movement MoveOf(VariationNode node) const;
+
+  // Number of moves from the root to node.
+  size_t Depth(VariationNode node) const;
+
+  // Same as Key() when node is the current node.
+  uint64_t KeyOf(VariationNode node) const;
+
+  // Moves from the root to node.
+  std::vector<Movement> Line(VariationNode node) const;
+
+ private:
+  struct Node {
+    uint64_t key;
+    VariationNode parent;
+    VariationNode first_child;
+    VariationNode next_sibling;
+    uint32_t depth;
+    Movement move;
+    // Takes move back, K_NO_MOVEMENT in it if move did not change the board.
+    MoveUndo undo;
+  };
+
+  std::vector<Node> nodes_;
+  VariationNode current_ = kRoot;
+  Board board_;
+  Player player_;
+
+  // Takes back the move of the current node.
+  void TakeBack();
+
+  // Makes the move of node, a child of the current node.
+  void Replay(VariationNode node);
+};
+
+}  // namespace xq
+
+#endif  // XIANGQI_GAME_ENGINE_INCLUDE_XIANGQI_VARIATION_TREE_H__
@@ -0,0 +1,214 @@
+#include <string.h>
+
+#include "xiangqi/bitboard_c.h"
+#include "xiangqi/board_c.h"
+#include "xiangqi/internal/simd_c.h"
+#include "xiangqi/internal/tables_c.h"
+#include "xiangqi/types_c.h"
+
+// --------------- Helper Function ---------------
+
+static inline BitboardC StepTargets(const StepsC* steps) {
+  BitboardC res = K_EMPTY_BITBOARD;
+  for (uint8_t i = 0; i < steps->count; i++) {
+    res |= BitboardOf(steps->dests[i]);
+  }
+  return res;
+}
+
+static inline BitboardC GeneralTargets(const Position pos, const bool is_red) {
+  return StepTargets(
+      &K_LEAPER_TABLES.general[is_red ? PLAYER_RED : PLAYER_BLACK][pos]);
+}
+
+static inline BitboardC AdvisorTargets(const Position pos, const bool is_red) {
+  return StepTargets(
+      &K_LEAPER_TABLES.advisor[is_red ? PLAYER_RED : PLAYER_BLACK][pos]);
+}
+
+static inline BitboardC SoldierTargets(const Position pos, const bool is_red) {
+  return StepTargets(
+      &K_LEAPER_TABLES.soldier[is_red ? PLAYER_RED : PLAYER_BLACK][pos]);
+}
+
+static inline BitboardC ElephantTargets(const BitboardC occupancy,
+                                        const Position pos,
+                                        const bool is_red) {
+  const ElephantLeapsC* leaps =
+      &K_LEAPER_TABLES.elephant[is_red ? PLAYER_RED : PLAYER_BLACK][pos];
+  BitboardC res = K_EMPTY_BITBOARD;
+  for (uint8_t i = 0; i < leaps->count; i++) {
+    if (!BitboardHas(occupancy, leaps->leaps[i].block)) {
+      res |= BitboardOf(leaps->leaps[i].dest);
+    }
+  }
+  return res;
+}
+
+static inline BitboardC HorseTargets(const BitboardC occupancy,
+                                     const Position pos) {
+  const HorseLeapsC* leaps = &K_LEAPER_TABLES.horse[pos];
+  BitboardC res = K_EMPTY_BITBOARD;
+  for (uint8_t i = 0; i < leaps->count; i++) {
+    if (!BitboardHas(occupancy, leaps->leaps[i].block)) {
+      res |= BitboardOf(leaps->leaps[i].dest);
+    }
+  }
+  return res;
+}
+
+static inline uint16_t BitboardRank(const BitboardC occupancy,
+                                    const uint8_t row) {
+  return (uint16_t)(occupancy >> (row * K_TOTAL_COL)) & 0x1FF;
+}
+
+// Converts rank and file masks of a slider at pos to a bitboard.
+static inline BitboardC SlideTargets(const Position pos,
+                                     const uint16_t rank_mask,
+                                     uint16_t file_mask) {
+  const uint8_t col = Col(pos);
+  BitboardC res = ((BitboardC)rank_mask) << (pos - col);
+  while (file_mask) {
+    res |= BitboardOf(__builtin_ctz(file_mask) * K_TOTAL_COL + col);
+    file_mask &= file_mask - 1;
+  }
+  return res;
+}
+
+static inline BitboardC ChariotTargets(const BitboardsC* bitboards,
+                                       const Position pos) {
+  const uint8_t row = Row(pos);
+  const uint8_t col = Col(pos);
+  return SlideTargets(
+      pos,
+      K_SLIDER_TABLES.rank[col][BitboardRank(bitboards->occupancy, row)]
+          .chariot,
+      K_SLIDER_TABLES.file[row][bitboards->files[col]].chariot);
+}
+
+static inline BitboardC CannonTargets(const BitboardsC* bitboards,
+                                      const Position pos) {
+  const uint8_t row = Row(pos);
+  const uint8_t col = Col(pos);
+  return SlideTargets(
+      pos,
+      K_SLIDER_TABLES.rank[col][BitboardRank(bitboards->occupancy, row)].cannon,
+      K_SLIDER_TABLES.file[row][bitboards->files[col]].cannon);
+}
+
+static inline BitboardC FlyingGeneralTarget(const BitboardsC* bitboards,
+                                            const Position pos,
+                                            const bool is_red) {
+  const BitboardC opponent_general =
+      bitboards->types[R_GENERAL] &
+      bitboards->colors[is_red ? PLAYER_BLACK : PLAYER_RED];
+  if (opponent_general == K_EMPTY_BITBOARD) {
+    return K_EMPTY_BITBOARD;
+  }
+  const uint8_t col = Col(pos);
+  return SlideTargets(
+             pos, 0,
+             K_SLIDER_TABLES.file[Row(pos)][bitboards->files[col]].chariot) &
+         opponent_general;
+}
+
+static inline uint8_t AddMoves(const Position from, BitboardC targets,
+                               Movement* out) {
+  uint8_t res = 0;
+  while (targets) {
+    *(out + res++) = NewMovement(from, BitboardPop(&targets));
+  }
+  return res;
+}
+
+// --------------- Public Function ---------------
+
+void BoardToBitboards_C(const BoardC board, BitboardsC* out) {
+  out->types[PIECE_EMPTY] = K_EMPTY_BITBOARD;
+  out->colors[PLAYER_RED] = K_EMPTY_BITBOARD;
+  out->colors[PLAYER_BLACK] = K_EMPTY_BITBOARD;
+  // One vector scan per piece.
+  for (uint8_t type = R_GENERAL; type <= R_SOLDIER; type++) {
+    const BitboardC red = BoardMatchMask(board, (enum Piece)type);
+    const BitboardC black = BoardMatchMask(board, (enum Piece)(-type));
+    out->types[type] = red | black;
+    out->colors[PLAYER_RED] |= red;
+    out->colors[PLAYER_BLACK] |= black;
+  }
+  out->occupancy = out->colors[PLAYER_RED] | out->colors[PLAYER_BLACK];
+  LineOccupancyC lines;
+  SplitLineOccupancy(out->occupancy, &lines);
+  memcpy(out->files, lines.files, sizeof(out->files));
+}
+
+void BitboardsToBoard_C(const BitboardsC* bitboards, BoardC out) {
+  ClearBoard_C(out);
+  for (uint8_t type = R_GENERAL; type <= R_SOLDIER; type++) {
+    BitboardC red = bitboards->types[type] & bitboards->colors[PLAYER_RED];
+    while (red) {
+      out[BitboardPop(&red)] = (enum Piece)type;
+    }
+    BitboardC black = bitboards->types[type] & bitboards->colors[PLAYER_BLACK];
+    while (black) {
+      out[BitboardPop(&black)] = (enum Piece)(-type);
+    }
+  }
+}
+
+uint8_t BitboardPossibleMoves_C(const BitboardsC* bitboards,
+                                const enum Player player,
+                                MaxMovesPerPlayerC out) {
+  memset(out, 0xFFFF, K_MAX_MOVE_PER_PLAYER * sizeof(Movement));
+  const bool is_red = player == PLAYER_RED;
+  const BitboardC own = bitboards->colors[player];
+  const BitboardC occupancy = bitboards->occupancy;
+  uint8_t res = 0;
+
+  BitboardC pieces = bitboards->types[R_GENERAL] & own;
+  while (pieces) {
+    const Position from = BitboardPop(&pieces);
+    const BitboardC targets =
+        (GeneralTargets(from, is_red) & ~own) |
+        FlyingGeneralTarget(bitboards, from, is_red);
+    res += AddMoves(from, targets, out + res);
+  }
+
+  pieces = bitboards->types[R_ADVISOR] & own;
+  while (pieces) {
+    const Position from = BitboardPop(&pieces);
+    res += AddMoves(from, AdvisorTargets(from, is_red) & ~own, out + res);
+  }
+
+  pieces = bitboards->types[R_ELEPHANT] & own;
+  while (pieces) {
+    const Position from = BitboardPop(&pieces);
+    res += AddMoves(from, ElephantTargets(occupancy, from, is_red) & ~own,
+                    out + res);
+  }
+
+  pieces = bitboards->types[R_HORSE] & own;
+  while (pieces) {
+    const Position from = BitboardPop(&pieces);
+    res += AddMoves(from, HorseTargets(occupancy, from) & ~own, out + res);
+  }
+
+  pieces = bitboards->types[R_CHARIOT] & own;
+  while (pieces) {
+    const Position from = BitboardPop(&pieces);
+    res += AddMoves(from, ChariotTargets(bitboards, from) & ~own, out + res);
+  }
+
+  pieces = bitboards->types[R_CANNON] & own;
+  while (pieces) {
+    const Position from = BitboardPop(&pieces);
+    res += AddMoves(from, CannonTargets(bitboards, from) & ~own, out + res);
+  }
+
+  pieces = bitboards->types[R_SOLDIER] & own;
+  while (pieces) {
+    const Position from = BitboardPop(&pieces);
+    res += AddMoves(from, SoldierTargets(from, is_red) & ~own, out + res);
+  }
+
+  return res;
+}
@@ -0,0 +1,31 @@
+#include "xiangqi/bitboard.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "xiangqi/bitboard_c.h"
+#include "xiangqi/board_c.h"
+#include "xiangqi/types.h"
+
+namespace xq {
+
+Bitboards BoardToBitboards(const Board& board) {
+  Bitboards result;
+  BoardToBitboards_C(board.data(), &result);
+  return result;
+}
+
+Board BitboardsToBoard(const Bitboards& bitboards) {
+  Board result;
+  BitboardsToBoard_C(&bitboards, result.data());
+  return result;
+}
+
+std::vector<Movement> BitboardPossibleMoves(const Bitboards& bitboards,
+                                            const Player player) {
+  MaxMovesPerPlayerC buff;
+  const uint8_t num_moves = BitboardPossibleMoves_C(&bitboards, player, buff);
+  return std::vector<Movement>{buff, buff + num_moves};
+}
+
+}  // namespace xq
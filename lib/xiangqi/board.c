@@ -1,13 +1,27 @@
 #include <string.h>
 
 #include "xiangqi/board_c.h"
+#include "xiangqi/internal/move_gen_c.h"
+#include "xiangqi/internal/simd_c.h"
+#include "xiangqi/internal/tables_c.h"
 #include "xiangqi/types_c.h"
 
 // --------------- Helper Function ---------------
 
-#define CAN_CAPTURE(a, b) ((b) ? ((a) <= 0) : ((a) >= 0))
-#define MIN(a, b) ((a) < (b) ? (a) : (b))
-#define MAX(a, b) ((a) > (b) ? (a) : (b))
+// Positions inside the palaces as masks over the first and the last 32
+// positions of the board, D0-F2 and D7-F9.
+#define K_TOP_PALACE_MASK 0x00E07038
+#define K_BOTTOM_PALACE_MASK 0x1C0E0700
+
+// Returns the first position of general inside the bottom or the top palace,
+// K_NO_POSITION if there is none. Each palace is a single 32-position scan.
+static inline Position FindInPalace(const BoardC board, const bool bottom,
+                                    const enum Piece general) {
+  const Position start = bottom ? K_BOARD_SIZE - 32 : 0;
+  const uint32_t mask = ChunkMatchMask(board + start, general) &
+                        (bottom ? K_BOTTOM_PALACE_MASK : K_TOP_PALACE_MASK);
+  return mask != 0 ? start + __builtin_ctz(mask) : K_NO_POSITION;
+}
 
 static inline char PieceToCh(const enum Piece piece, const uint8_t row,
                              const uint8_t col) {
@@ -54,649 +68,439 @@ static inline char PieceToCh(const enum Piece piece, const uint8_t row,
   }
 }
 
-static inline bool IsPathClear(const BoardC board, const Position from,
-                               const Position to) {
-  const uint8_t start = from < to ? from : to;
-  const uint8_t end = from > to ? from : to;
-  if (end - start < K_TOTAL_COL) {  // same row
-    for (uint8_t pos = start + 1; pos < end; pos++) {
-      if (board[pos] != PIECE_EMPTY) {
-        return false;
-      }
-    }
-    return true;
-  } else if (Col(from) == Col(to)) {
-    for (uint8_t pos = start + K_TOTAL_COL; pos < end; pos += K_TOTAL_COL) {
-      if (board[pos] != PIECE_EMPTY) {
-        return false;
-      }
-    }
-    return true;
-  }
-  return false;
+// Returns true if pos is on the rank or file of general, or diagonally next
+// to it.
+static inline bool NearGeneral(const Position general, const Position pos) {
+  const int8_t rows = (int8_t)Row(pos) - (int8_t)Row(general);
+  const int8_t cols = (int8_t)Col(pos) - (int8_t)Col(general);
+  return rows == 0 || cols == 0 ||
+         ((rows == 1 || rows == -1) && (cols == 1 || cols == -1));
 }
 
-static inline bool ThreatensBySoldier(const enum Piece soldier,
-                                      const Position pos,
-                                      const Position target) {
-  const uint8_t pos_col = Col(pos);
-  return ((soldier == R_SOLDIER) &&
-          ((pos == target + K_TOTAL_COL) ||                    // up
-           (pos < K_RED_RIVER_START &&                         // crossed river
-            ((pos_col < K_TOTAL_COL - 1 && pos + 1 == target)  // right
-             || (pos_col > 0 && target + 1 == pos)             // left
-             )))) ||
-         ((soldier == B_SOLDIER) &&
-          ((pos + K_TOTAL_COL == target) ||                    // down
-           (pos >= K_RED_RIVER_START &&                        // crossed river
-            ((pos_col < K_TOTAL_COL - 1 && pos + 1 == target)  // right
-             || (pos_col > 0 && target + 1 == pos)             // left
-             ))));
+// Same as IsBeingCheckmate_C, specialized when player is a constant.
+FORCE_INLINE bool PlayerIsThreatened(const BoardC board,
+                                     const enum Player player) {
+  const Position general_pos = FindGeneral_C(board, player);
+  return general_pos == K_NO_POSITION ||
+         PlayerAttacks(board, general_pos, ChangePlayer(player));
 }
 
-static inline bool ThreatensByHorse(const BoardC board, const Position pos,
-                                    const Position target) {
-  const uint8_t pos_row = Row(pos);
-  const uint8_t pos_col = Col(pos);
-  if ((target > pos + K_TOTAL_COL)    // target at least one row below
-      && (pos_row < K_TOTAL_ROW - 2)  // can move down for 2 rows
-      && board[pos + K_TOTAL_COL] == PIECE_EMPTY  // not blocked
-  ) {
-    const uint8_t down_2_row = pos + K_TOTAL_COL * 2;
-    if ((pos_col > 0 && down_2_row - 1 == target)                   // left 1
-        || (pos_col < K_TOTAL_COL - 1 && down_2_row + 1 == target)  // right 1
-    ) {
-      return true;
-    }
-  } else if ((target + K_TOTAL_COL < pos)  // target at least one row above
-             && (pos_row > 1)              // can move up for 2 rows
-             && (board[pos - K_TOTAL_COL] == PIECE_EMPTY)  // not blocked
-  ) {
-    const uint8_t up_2_row = pos - K_TOTAL_COL * 2;
-    if ((pos_col > 0 && up_2_row == target + 1)                   // left 1
-        || (pos_col < K_TOTAL_COL - 1 && up_2_row + 1 == target)  // right 1
-    ) {
-      return true;
-    }
-  }
-  return (pos_col < K_TOTAL_COL - 2         // can move right for 2 columns
-          && board[pos + 1] == PIECE_EMPTY  // not blocked
-          && ((pos_row < K_TOTAL_ROW - 1 &&
-               pos + K_TOTAL_COL + 2 == target)                    // down 1
-              || (pos_row > 0 && target + K_TOTAL_COL - 2 == pos)  // up 1
-              )) ||
-         (pos_col > 1                       // can move left for 2 columns
-          && board[pos - 1] == PIECE_EMPTY  // not blocked
-          && ((pos_row < K_TOTAL_ROW - 1 &&
-               pos + K_TOTAL_COL - 2 == target)                    // down 1
-              || (pos_row > 0 && target + K_TOTAL_COL + 2 == pos)  // up 1
-              ));
+// Returns true if making the move does not leave player's general threatened.
+// Capturing the opponent's general is always allowed. The move is made and
+// taken back in place, board is unchanged when this returns.
+FORCE_INLINE bool IsLegalMove(BoardC board, const enum Player player,
+                              const Movement movement) {
+  MoveUndoC undo;
+  const enum Piece captured = MakeMove_C(board, movement, &undo);
+  const bool res = captured == R_GENERAL || captured == B_GENERAL ||
+                   !PlayerIsThreatened(board, player);
+  UnmakeMove_C(board, &undo);
+  return res;
 }
 
-static inline bool ThreatensByCannon(const BoardC board, const Position pos,
-                                     const Position target) {
-  if (Row(pos) == Row(target)) {
-    bool found_in_between = false;
-    for (uint8_t p = (pos < target ? pos : target) + 1;
-         p < (pos > target ? pos : target); p++) {
-      if (board[p] != PIECE_EMPTY) {
-        if (found_in_between) {
-          return false;
-        } else {
-          found_in_between = true;
-        }
-      }
-    }
-    return found_in_between;
-  } else if (Col(pos) == Col(target)) {
-    bool found_in_between = false;
-    for (uint8_t p = (pos < target ? pos : target) + K_TOTAL_COL;
-         p < (pos > target ? pos : target); p += K_TOTAL_COL) {
-      if (board[p] != PIECE_EMPTY) {
-        if (found_in_between) {
-          return false;
-        } else {
-          found_in_between = true;
-        }
-      }
-    }
-    return found_in_between;
-  }
-  return false;
+static inline void ComputeBoardCheckInfo(const BoardC board,
+                                         const enum Player player,
+                                         CheckInfoC* out) {
+  ComputeCheckInfo(board, FindGeneral_C(board, player),
+                   IsBeingCheckmate_C(board, player), out);
 }
 
-static inline uint8_t PossiblePositionsGeneral(const BoardC board,
-                                               const Position pos,
-                                               const Position opponent_general,
-                                               Position* out) {
-  uint8_t res = 0;
-
-  // Flying general check.
-  const enum Piece piece = board[pos];
-  bool is_blocked = false;
-  if (opponent_general != K_NO_POSITION && Col(opponent_general) == Col(pos)) {
-    for (Position cur = MIN(pos, opponent_general) + K_TOTAL_COL;
-         cur < MAX(pos, opponent_general); cur += K_TOTAL_COL) {
-      if (!IsEmpty(board[cur])) {
-        is_blocked = true;
-        break;
-      }
-    }
-    if (!is_blocked) {
-      *(out + res++) = opponent_general;
-    }
-  }
-
-  if (piece == R_GENERAL) {
-    if (((pos >= 66 && pos <= 68) || (pos >= 75 && pos <= 77)) &&
-        !IsRed(board[pos + K_TOTAL_COL])) {
-      // move down
-      *(out + res++) = pos + K_TOTAL_COL;
-    }
-    if (((pos >= 75 && pos <= 77) || (pos >= 84 && pos <= 86)) &&
-        !IsRed(board[pos - K_TOTAL_COL])) {
-      // move up
-      *(out + res++) = pos - K_TOTAL_COL;
-    }
-    if ((pos == 66 || pos == 67 || pos == 75 || pos == 76 || pos == 84 ||
-         pos == 85) &&
-        !IsRed(board[pos + 1])) {
-      // move right
-      *(out + res++) = pos + 1;
-    }
-    if ((pos == 67 || pos == 68 || pos == 76 || pos == 77 || pos == 85 ||
-         pos == 86) &&
-        !IsRed(board[pos - 1])) {
-      // move left
-      *(out + res++) = pos - 1;
-    }
-  } else if (piece == B_GENERAL) {
-    if (((pos >= 3 && pos <= 5) || (pos >= 12 && pos <= 14)) &&
-        !IsBlack(board[pos + K_TOTAL_COL])) {
-      // move down
-      *(out + res++) = pos + K_TOTAL_COL;
-    }
-    if (((pos >= 12 && pos <= 14) || (pos >= 21 && pos <= 23)) &&
-        !IsBlack(board[pos - K_TOTAL_COL])) {
-      // move up
-      *(out + res++) = pos - K_TOTAL_COL;
-    }
-    if ((pos == 3 || pos == 4 || pos == 12 || pos == 13 || pos == 21 ||
-         pos == 22) &&
-        !IsBlack(board[pos + 1])) {
-      // move right
-      *(out + res++) = pos + 1;
-    }
-    if ((pos == 4 || pos == 5 || pos == 13 || pos == 14 || pos == 22 ||
-         pos == 23) &&
-        !IsBlack(board[pos - 1])) {
-      // move left
-      *(out + res++) = pos - 1;
+// Removes destinations of the piece at pos that leave player's general
+// threatened, only making the moves flagged by info. Removed destinations are
+// replaced by the last one. Returns the number of remaining destinations.
+FORCE_INLINE uint8_t FilterLegalPositions(BoardC scratch,
+                                          const enum Player player,
+                                          const CheckInfoC* info,
+                                          const Position pos, Position* out,
+                                          uint8_t res) {
+  for (uint8_t i = 0; i < res;) {
+    if (NeedsVerification(info, pos, out[i]) &&
+        !IsLegalMove(scratch, player, NewMovement(pos, out[i]))) {
+      out[i] = out[res - 1];
+      out[res - 1] = K_NO_POSITION;
+      res--;
+    } else {
+      i++;
     }
   }
   return res;
 }
 
-static inline uint8_t PossiblePositionsAdvisor(const BoardC board,
-                                               const Position pos,
-                                               Position* out) {
+// Shared implementation of the move generators, only out[0, return value) is
+// written. Always called with a constant player, see PossibleMovesOfKind.
+FORCE_INLINE uint8_t PlayerMovesOfKind(const BoardC board,
+                                       const enum Player player,
+                                       const bool avoid_checkmate,
+                                       const enum MoveKind kind,
+                                       Movement* out) {
+  CheckInfoC info = {0};
+  BoardC scratch;
+  if (avoid_checkmate) {
+    ComputeBoardCheckInfo(board, player, &info);
+    CopyBoard_C(scratch, board);
+  }
+  const Position opponent_general = FindGeneral_C(board, ChangePlayer(player));
   uint8_t res = 0;
-
-  if (IsRed(board[pos])) {
-    switch (pos) {
-      case 84:  // D9
-      case 86:  // F9
-      case 66:  // D7
-      case 68:  // F7
-        if (!IsRed(board[76])) {
-          *(out + res++) = 76;  // E8
-        }
-        break;
-      case 76:  // E8
-        if (!IsRed(board[84])) {
-          *(out + res++) = 84;
-        }
-        if (!IsRed(board[86])) {
-          *(out + res++) = 86;
-        }
-        if (!IsRed(board[66])) {
-          *(out + res++) = 66;
-        }
-        if (!IsRed(board[68])) {
-          *(out + res++) = 68;
-        }
-        break;
+  MovesPerPieceC buff;
+  for (uint8_t pos = 0; pos < K_BOARD_SIZE; pos++) {
+    const enum Piece piece = board[pos];
+    if (player == PLAYER_RED ? piece <= 0 : piece >= 0) {
+      continue;
     }
-  } else {
-    switch (pos) {
-      case 3:   // D0
-      case 5:   // F0
-      case 21:  // D2
-      case 23:  // F2
-        if (!IsBlack(board[13])) {
-          *(out + res++) = 13;  // E1
-        }
-        break;
-      case 13:  // E1
-        if (!IsBlack(board[3])) {
-          *(out + res++) = 3;
-        }
-        if (!IsBlack(board[5])) {
-          *(out + res++) = 5;
-        }
-        if (!IsBlack(board[21])) {
-          *(out + res++) = 21;
-        }
-        if (!IsBlack(board[23])) {
-          *(out + res++) = 23;
-        }
-        break;
+    uint8_t num_moves = PlayerPseudoPositions(board, pos, player,
+                                              opponent_general, kind, buff);
+    if (avoid_checkmate) {
+      num_moves =
+          FilterLegalPositions(scratch, player, &info, pos, buff, num_moves);
+    }
+    for (uint8_t i = 0; i < num_moves; ++i) {
+      *(out + res++) = NewMovement(pos, buff[i]);
     }
   }
-
   return res;
 }
 
-static inline uint8_t PossiblePositionsElephant(const BoardC board,
-                                                const Position pos,
-                                                Position* out) {
-  uint8_t res = 0;
+// Dispatches to a copy of PlayerMovesOfKind specialized for player.
+static inline uint8_t PossibleMovesOfKind(const BoardC board,
+                                          const enum Player player,
+                                          const bool avoid_checkmate,
+                                          const enum MoveKind kind,
+                                          Movement* out) {
+  return player == PLAYER_RED
+             ? PlayerMovesOfKind(board, PLAYER_RED, avoid_checkmate, kind, out)
+             : PlayerMovesOfKind(board, PLAYER_BLACK, avoid_checkmate, kind,
+                                 out);
+}
 
-  if (IsRed(board[pos])) {
-    switch (pos) {
-      case 83:  // C9
-        if (!IsRed(board[63]) && IsEmpty(board[73])) {
-          *(out + res++) = 63;
-        }
-        if (!IsRed(board[67]) && IsEmpty(board[75])) {
-          *(out + res++) = 67;
-        }
-        break;
-      case 87:  // G9
-        if (!IsRed(board[71]) && IsEmpty(board[79])) {
-          *(out + res++) = 71;
-        }
-        if (!IsRed(board[67]) && IsEmpty(board[77])) {
-          *(out + res++) = 67;
-        }
-        break;
-      case 63:  // A7
-        if (!IsRed(board[47]) && IsEmpty(board[55])) {
-          *(out + res++) = 47;
-        }
-        if (!IsRed(board[83]) && IsEmpty(board[73])) {
-          *(out + res++) = 83;
-        }
-        break;
-      case 71:  // I7
-        if (!IsRed(board[51]) && IsEmpty(board[61])) {
-          *(out + res++) = 51;
-        }
-        if (!IsRed(board[87]) && IsEmpty(board[79])) {
-          *(out + res++) = 87;
-        }
-        break;
-      case 47:  // C5
-        if (!IsRed(board[63]) && IsEmpty(board[55])) {
-          *(out + res++) = 63;
-        }
-        if (!IsRed(board[67]) && IsEmpty(board[57])) {
-          *(out + res++) = 67;
-        }
-        break;
-      case 51:  // G5
-        if (!IsRed(board[71]) && IsEmpty(board[61])) {
-          *(out + res++) = 71;
-        }
-        if (!IsRed(board[67]) && IsEmpty(board[59])) {
-          *(out + res++) = 67;
-        }
-        break;
-      case 67:  // E7
-        if (!IsRed(board[47]) && IsEmpty(board[57])) {
-          *(out + res++) = 47;
-        }
-        if (!IsRed(board[83]) && IsEmpty(board[75])) {
-          *(out + res++) = 83;
-        }
-        if (!IsRed(board[51]) && IsEmpty(board[59])) {
-          *(out + res++) = 51;
-        }
-        if (!IsRed(board[87]) && IsEmpty(board[77])) {
-          *(out + res++) = 87;
-        }
-        break;
-    }
-  } else {
-    switch (pos) {
-      case 2:  // C0
-        if (!IsBlack(board[18]) && IsEmpty(board[10])) {
-          *(out + res++) = 18;
-        }
-        if (!IsBlack(board[22]) && IsEmpty(board[12])) {
-          *(out + res++) = 22;
-        }
-        break;
-      case 6:  // G0
-        if (!IsBlack(board[26]) && IsEmpty(board[16])) {
-          *(out + res++) = 26;
-        }
-        if (!IsBlack(board[22]) && IsEmpty(board[14])) {
-          *(out + res++) = 22;
-        }
-        break;
-      case 18:  // A2
-        if (!IsBlack(board[2]) && IsEmpty(board[10])) {
-          *(out + res++) = 2;
-        }
-        if (!IsBlack(board[38]) && IsEmpty(board[28])) {
-          *(out + res++) = 38;
-        }
-        break;
-      case 26:  // I2
-        if (!IsBlack(board[6]) && IsEmpty(board[16])) {
-          *(out + res++) = 6;
-        }
-        if (!IsBlack(board[42]) && IsEmpty(board[34])) {
-          *(out + res++) = 42;
-        }
-        break;
-      case 38:  // C4
-        if (!IsBlack(board[18]) && IsEmpty(board[28])) {
-          *(out + res++) = 18;
-        }
-        if (!IsBlack(board[22]) && IsEmpty(board[30])) {
-          *(out + res++) = 22;
-        }
-        break;
-      case 42:  // G4
-        if (!IsBlack(board[26]) && IsEmpty(board[34])) {
-          *(out + res++) = 26;
-        }
-        if (!IsBlack(board[22]) && IsEmpty(board[32])) {
-          *(out + res++) = 22;
-        }
-        break;
-      case 22:  // E2
-        if (!IsBlack(board[2]) && IsEmpty(board[12])) {
-          *(out + res++) = 2;
-        }
-        if (!IsBlack(board[6]) && IsEmpty(board[14])) {
-          *(out + res++) = 6;
-        }
-        if (!IsBlack(board[38]) && IsEmpty(board[30])) {
-          *(out + res++) = 38;
-        }
-        if (!IsBlack(board[42]) && IsEmpty(board[32])) {
-          *(out + res++) = 42;
-        }
-        break;
-    }
+// Positions a move of player has to reach (to) or leave (from) to get out of
+// the checks on its general, see AddEvasionTargets. Moves of the general
+// itself are not limited. Without a general every move has to be verified.
+static inline void ComputeEvasionTargets(const BoardC board,
+                                         const enum Player player,
+                                         const Position general,
+                                         const Position opponent_general,
+                                         BitboardC* to, BitboardC* from) {
+  *to = ~K_EMPTY_BITBOARD;
+  *from = K_EMPTY_BITBOARD;
+  if (general != K_NO_POSITION) {
+    *to = K_EMPTY_BITBOARD;
+    GeneralSlidesC slides = NewGeneralSlides(general);
+    BitboardC opponent_pieces = BoardPlayerMask(board, ChangePlayer(player));
+    while (opponent_pieces != K_EMPTY_BITBOARD) {
+      const Position pos = BitboardPop(&opponent_pieces);
+      if (ThreatensGeneral(board, pos, &slides)) {
+        AddEvasionTargets(board, general, pos, to, from);
+      }
+    }
+  }
+  // Capturing the opponent's general is always allowed.
+  if (opponent_general != K_NO_POSITION) {
+    *to |= BitboardOf(opponent_general);
   }
-  return res;
 }
 
-static inline uint8_t PossiblePositionsHorse(const BoardC board,
-                                             const Position pos,
-                                             Position* out) {
-  const bool is_red = IsRed(board[pos]);
-  const uint8_t col = Col(pos);
-  uint8_t res = 0;
-
-  if (pos > 17) {                             // can move up 2
-    if (IsEmpty(board[pos - K_TOTAL_COL])) {  // not blocked
-      const Position up = pos - 2 * K_TOTAL_COL;
-      if (col > 0 && CAN_CAPTURE(board[up - 1], is_red)) {
-        *(out + res++) = up - 1;
-      }
-      if (col < K_TOTAL_COL - 1 && CAN_CAPTURE(board[up + 1], is_red)) {
-        *(out + res++) = up + 1;
+// Returns true if player has a move that does not leave its general
+// threatened, stopping at the first one found. Always called with a constant
+// player, see HasAnyLegalMove_C.
+FORCE_INLINE bool PlayerHasLegalMove(const BoardC board,
+                                     const enum Player player,
+                                     const Position general,
+                                     const Position opponent_general) {
+  const BitboardC pieces = BoardPlayerMask(board, player);
+  BoardC scratch;
+  MovesPerPieceC buff;
+  if (general == K_NO_POSITION ||
+      PlayerAttacks(board, general, ChangePlayer(player))) {
+    // Only moves that can resolve the check are made. Stepping the general
+    // away is tried first, since it needs no evasion targets.
+    CopyBoard_C(scratch, board);
+    BitboardC left = pieces;
+    if (general != K_NO_POSITION) {
+      left &= ~BitboardOf(general);
+      const uint8_t num_moves = PlayerPseudoPositions(
+          board, general, player, opponent_general, MOVE_KIND_ALL, buff);
+      for (uint8_t i = 0; i < num_moves; i++) {
+        if (IsLegalMove(scratch, player, NewMovement(general, buff[i]))) {
+          return true;
+        }
       }
     }
-  }
-  if (pos < 72) {                             // can move down 2
-    if (IsEmpty(board[pos + K_TOTAL_COL])) {  // not blocked
-      const Position down = pos + 2 * K_TOTAL_COL;
-      if (col > 0 && CAN_CAPTURE(board[down - 1], is_red)) {
-        *(out + res++) = down - 1;
-      }
-      if (col < K_TOTAL_COL - 1 && CAN_CAPTURE(board[down + 1], is_red)) {
-        *(out + res++) = down + 1;
+    BitboardC evasion_to;
+    BitboardC evasion_from;
+    ComputeEvasionTargets(board, player, general, opponent_general,
+                          &evasion_to, &evasion_from);
+    while (left != K_EMPTY_BITBOARD) {
+      const Position pos = BitboardPop(&left);
+      const bool any_dest = BitboardHas(evasion_from, pos);
+      const uint8_t num_moves = PlayerPseudoPositions(
+          board, pos, player, opponent_general, MOVE_KIND_ALL, buff);
+      for (uint8_t i = 0; i < num_moves; i++) {
+        if ((any_dest || BitboardHas(evasion_to, buff[i])) &&
+            IsLegalMove(scratch, player, NewMovement(pos, buff[i]))) {
+          return true;
+        }
       }
     }
+    return false;
   }
-  if (col > 1) {                    // can move left 2
-    if (IsEmpty(board[pos - 1])) {  // not blocked
-      const Position left = pos - 2;
-      if (pos > 8 && CAN_CAPTURE(board[left - K_TOTAL_COL], is_red)) {
-        *(out + res++) = left - K_TOTAL_COL;
-      }
-      if (pos < 81 && CAN_CAPTURE(board[left + K_TOTAL_COL], is_red)) {
-        *(out + res++) = left + K_TOTAL_COL;
+
+  // Pieces away from the general's lines can make any move that does not land
+  // on one of them, so the first such piece usually ends the search.
+  CheckInfoC info = {0};
+  ComputeCheckInfo(board, general, false, &info);
+  BitboardC safe = pieces & ~info.risky_from & ~BitboardOf(general);
+  while (safe != K_EMPTY_BITBOARD) {
+    const Position pos = BitboardPop(&safe);
+    const uint8_t num_moves = PlayerPseudoPositions(
+        board, pos, player, opponent_general, MOVE_KIND_ALL, buff);
+    for (uint8_t i = 0; i < num_moves; i++) {
+      if (!BitboardHas(info.risky_to, buff[i])) {
+        return true;
       }
     }
   }
-  if (col < K_TOTAL_COL - 2) {      // can move right 2
-    if (IsEmpty(board[pos + 1])) {  // not blocked
-      const Position right = pos + 2;
-      if (pos > 8 && CAN_CAPTURE(board[right - K_TOTAL_COL], is_red)) {
-        *(out + res++) = right - K_TOTAL_COL;
-      }
-      if (pos < 81 && CAN_CAPTURE(board[right + K_TOTAL_COL], is_red)) {
-        *(out + res++) = right + K_TOTAL_COL;
+  // Every move left has to be verified.
+  CopyBoard_C(scratch, board);
+  for (BitboardC left = pieces; left != K_EMPTY_BITBOARD;) {
+    const Position pos = BitboardPop(&left);
+    const uint8_t num_moves = PlayerPseudoPositions(
+        board, pos, player, opponent_general, MOVE_KIND_ALL, buff);
+    for (uint8_t i = 0; i < num_moves; i++) {
+      if (NeedsVerification(&info, pos, buff[i]) &&
+          IsLegalMove(scratch, player, NewMovement(pos, buff[i]))) {
+        return true;
       }
     }
   }
-
-  return res;
+  return false;
 }
 
-static inline uint8_t PossiblePositionsChariot(const BoardC board,
-                                               const Position pos,
-                                               Position* out) {
-  const bool is_red = IsRed(board[pos]);
-  uint8_t res = 0;
-
-  // Up
-  for (int8_t cur = ((int8_t)pos) - K_TOTAL_COL; cur >= 0; cur -= K_TOTAL_COL) {
-    if (CAN_CAPTURE(board[cur], is_red)) {
-      *(out + res++) = cur;
-      if (!IsEmpty(board[cur])) {
-        break;
-      }
-    } else {
-      break;
-    }
+// BoardStateC holds 16 bytes per player, red first, most significant byte
+// first within each word. A player's bytes are the positions of its general,
+// 2 advisors, 2 elephants, 2 horses, 2 chariots, 2 cannons and 5 soldiers,
+// sorted within each kind and padded with K_NO_POSITION.
+#define K_BOARD_STATE_BYTES 32
+#define K_PLAYER_STATE_BYTES 16
+
+// First and last byte of each kind's slots, indexed by Piece + R_SOLDIER.
+static const uint8_t K_STATE_FIRST_SLOT[K_TOTAL_PIECE_VALUES] = {
+    27, 25, 23, 21, 19, 17, 16, 0, 0, 1, 3, 5, 7, 9, 11};
+static const uint8_t K_STATE_LAST_SLOT[K_TOTAL_PIECE_VALUES] = {
+    31, 26, 24, 22, 20, 18, 16, 0, 0, 2, 4, 6, 8, 10, 15};
+
+// Piece stored in each byte of a state.
+static const enum Piece K_STATE_SLOT_PIECES[K_BOARD_STATE_BYTES] = {
+    R_GENERAL,  R_ADVISOR,  R_ADVISOR,  R_ELEPHANT, R_ELEPHANT, R_HORSE,
+    R_HORSE,    R_CHARIOT,  R_CHARIOT,  R_CANNON,   R_CANNON,   R_SOLDIER,
+    R_SOLDIER,  R_SOLDIER,  R_SOLDIER,  R_SOLDIER,  B_GENERAL,  B_ADVISOR,
+    B_ADVISOR,  B_ELEPHANT, B_ELEPHANT, B_HORSE,    B_HORSE,    B_CHARIOT,
+    B_CHARIOT,  B_CANNON,   B_CANNON,   B_SOLDIER,  B_SOLDIER,  B_SOLDIER,
+    B_SOLDIER,  B_SOLDIER};
+
+// Converts size bytes of a state to and from its words, most significant byte
+// first.
+static inline void StateToBytes(const uint64_t* state, const uint8_t size,
+                                uint8_t* out) {
+  for (uint8_t word = 0; word < size / 8; word++) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    const uint64_t bytes = __builtin_bswap64(state[word]);
+#else
+    const uint64_t bytes = state[word];
+#endif
+    memcpy(out + word * 8, &bytes, 8);
   }
+}
 
-  // Down
-  for (int8_t cur = pos + K_TOTAL_COL; cur < K_BOARD_SIZE; cur += K_TOTAL_COL) {
-    if (CAN_CAPTURE(board[cur], is_red)) {
-      *(out + res++) = cur;
-      if (!IsEmpty(board[cur])) {
-        break;
-      }
-    } else {
-      break;
-    }
+static inline void BytesToState(const uint8_t* bytes, const uint8_t size,
+                                uint64_t* out) {
+  for (uint8_t word = 0; word < size / 8; word++) {
+    uint64_t res;
+    memcpy(&res, bytes + word * 8, 8);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    res = __builtin_bswap64(res);
+#endif
+    out[word] = res;
   }
+}
 
-  // Left
-  for (int8_t cur = ((int8_t)pos) - 1; cur >= (pos - pos % K_TOTAL_COL);
-       cur--) {
-    if (CAN_CAPTURE(board[cur], is_red)) {
-      *(out + res++) = cur;
-      if (!IsEmpty(board[cur])) {
-        break;
+// Moves piece from one position to another within the slots of its kind,
+// keeping them sorted. from may be K_NO_POSITION to add the piece, to may be
+// K_NO_POSITION to remove it. Only the owner's half of state is touched.
+static inline void MovePieceInState(BoardStateC state, const enum Piece piece,
+                                    const Position from, const Position to) {
+  if (piece == PIECE_EMPTY) {
+    return;
+  }
+  const uint8_t first = K_STATE_FIRST_SLOT[piece + R_SOLDIER];
+  const uint8_t last = K_STATE_LAST_SLOT[piece + R_SOLDIER];
+  uint64_t* words = state + (first < K_PLAYER_STATE_BYTES ? 0 : 2);
+  uint8_t bytes[K_PLAYER_STATE_BYTES];
+  StateToBytes(words, K_PLAYER_STATE_BYTES, bytes);
+  uint8_t* slots = bytes + first % K_PLAYER_STATE_BYTES;
+  const uint8_t size = last - first + 1;
+  if (from != K_NO_POSITION) {
+    uint8_t i = 0;
+    while (i < size && slots[i] != from) {
+      i++;
+    }
+    if (i < size) {
+      for (; i + 1 < size; i++) {
+        slots[i] = slots[i + 1];
       }
-    } else {
-      break;
+      slots[size - 1] = K_NO_POSITION;
     }
   }
-
-  // Right
-  for (int8_t cur = pos + 1; cur < ((pos / K_TOTAL_COL + 1) * K_TOTAL_COL);
-       cur++) {
-    if (CAN_CAPTURE(board[cur], is_red)) {
-      *(out + res++) = cur;
-      if (!IsEmpty(board[cur])) {
-        break;
-      }
-    } else {
-      break;
+  if (to != K_NO_POSITION) {
+    // The last slot is free on valid boards, larger positions and padding
+    // shift towards it.
+    uint8_t i = size - 1;
+    for (; i > 0 && slots[i - 1] > to; i--) {
+      slots[i] = slots[i - 1];
     }
+    slots[i] = to;
   }
-
-  return res;
+  BytesToState(bytes, K_PLAYER_STATE_BYTES, words);
 }
 
-static inline uint8_t PossiblePositionsCannon(const BoardC board,
-                                              const Position pos,
-                                              Position* out) {
-  const bool is_red = IsRed(board[pos]);
-  uint8_t res = 0;
+// --------------- Public Function ---------------
 
-  // Up
-  bool blocked = false;
-  for (int8_t cur = ((int8_t)pos) - K_TOTAL_COL; cur >= 0; cur -= K_TOTAL_COL) {
-    if (IsEmpty(board[cur])) {
-      if (!blocked) {
-        *(out + res++) = cur;
-      }
-    } else {
-      if (blocked) {
-        if (CAN_CAPTURE(board[cur], is_red)) {
-          *(out + res++) = cur;
-        }
-        break;
-      } else {
-        blocked = true;
-      }
+void BoardToString_C(const BoardC board, char out[K_BOARD_STR_SIZE]) {
+  out[K_BOARD_STR_SIZE - 1] = '\0';
+  strcpy(out, "  A B C D E F G H I \n");
+  out += 21;
+  for (uint8_t row = 0; row < K_TOTAL_ROW; row++) {
+    *(out++) = ('0' + row);
+    *(out++) = ' ';
+    for (uint8_t col = 0; col < K_TOTAL_COL; col++) {
+      *(out++) = PieceToCh(board[Pos(row, col)], row, col);
+      *(out++) = ' ';
     }
+    *(out++) = '\n';
   }
+}
 
-  // Down
-  blocked = false;
-  for (int8_t cur = pos + K_TOTAL_COL; cur < K_BOARD_SIZE; cur += K_TOTAL_COL) {
-    if (IsEmpty(board[cur])) {
-      if (!blocked) {
-        *(out + res++) = cur;
-      }
-    } else {
-      if (blocked) {
-        if (CAN_CAPTURE(board[cur], is_red)) {
-          *(out + res++) = cur;
-        }
-        break;
-      } else {
-        blocked = true;
-      }
-    }
+// FEN letter of each piece, indexed by piece + 7.
+static const char K_FEN_CHARS[] = "pcrnbak.KABNRCP";
+
+// Piece of a FEN letter, PIECE_EMPTY for anything else.
+static inline enum Piece FenChToPiece(const char ch) {
+  switch (ch) {
+    case 'K':
+      return R_GENERAL;
+    case 'A':
+      return R_ADVISOR;
+    case 'B':
+    case 'E':
+      return R_ELEPHANT;
+    case 'N':
+    case 'H':
+      return R_HORSE;
+    case 'R':
+      return R_CHARIOT;
+    case 'C':
+      return R_CANNON;
+    case 'P':
+      return R_SOLDIER;
+    case 'k':
+      return B_GENERAL;
+    case 'a':
+      return B_ADVISOR;
+    case 'b':
+    case 'e':
+      return B_ELEPHANT;
+    case 'n':
+    case 'h':
+      return B_HORSE;
+    case 'r':
+      return B_CHARIOT;
+    case 'c':
+      return B_CANNON;
+    case 'p':
+      return B_SOLDIER;
+    default:
+      return PIECE_EMPTY;
   }
+}
 
-  // Left
-  blocked = false;
-  for (int8_t cur = ((int8_t)pos) - 1; cur >= (pos - pos % K_TOTAL_COL);
-       cur--) {
-    if (IsEmpty(board[cur])) {
-      if (!blocked) {
-        *(out + res++) = cur;
-      }
-    } else {
-      if (blocked) {
-        if (CAN_CAPTURE(board[cur], is_red)) {
-          *(out + res++) = cur;
-        }
-        break;
-      } else {
-        blocked = true;
-      }
+uint8_t BoardToFen_C(const BoardC board, const enum Player player,
+                     char out[K_FEN_STR_SIZE]) {
+  char* cur = out;
+  for (uint8_t row = 0; row < K_TOTAL_ROW; row++) {
+    if (row > 0) {
+      *(cur++) = '/';
     }
-  }
-
-  // Right
-  blocked = false;
-  for (int8_t cur = pos + 1; cur < ((pos / K_TOTAL_COL + 1) * K_TOTAL_COL);
-       cur++) {
-    if (IsEmpty(board[cur])) {
-      if (!blocked) {
-        *(out + res++) = cur;
+    char empty = 0;
+    for (uint8_t col = 0; col < K_TOTAL_COL; col++) {
+      const enum Piece piece = board[Pos(row, col)];
+      if (piece == PIECE_EMPTY) {
+        empty++;
+        continue;
       }
-    } else {
-      if (blocked) {
-        if (CAN_CAPTURE(board[cur], is_red)) {
-          *(out + res++) = cur;
-        }
-        break;
-      } else {
-        blocked = true;
+      if (empty > 0) {
+        *(cur++) = '0' + empty;
+        empty = 0;
       }
+      *(cur++) = K_FEN_CHARS[piece + 7];
+    }
+    if (empty > 0) {
+      *(cur++) = '0' + empty;
     }
   }
-
-  return res;
+  memcpy(cur, player == PLAYER_RED ? " w - - 0 1" : " b - - 0 1", 11);
+  return (uint8_t)(cur - out + 10);
 }
 
-static inline uint8_t PossiblePositionsSoldier(const BoardC board,
-                                               const Position pos,
-                                               Position* out) {
-  const bool is_red = IsRed(board[pos]);
-  uint8_t res = 0;
-
-  if (is_red) {
-    if (pos >= K_RED_RIVER_START &&
-        CAN_CAPTURE(board[pos - K_TOTAL_COL], is_red)) {
-      *out = pos - K_TOTAL_COL;
-      return 1;
-    } else {
-      if (pos >= K_TOTAL_COL && CAN_CAPTURE(board[pos - K_TOTAL_COL], is_red)) {
-        *(out + res++) = pos - K_TOTAL_COL;
-      }
-      const uint8_t col = Col(pos);
-      if (col > 0 && CAN_CAPTURE(board[pos - 1], is_red)) {
-        *(out + res++) = pos - 1;
-      }
-      if (col < K_TOTAL_COL - 1 && CAN_CAPTURE(board[pos + 1], is_red)) {
-        *(out + res++) = pos + 1;
+bool BoardFromFen_C(const char* fen, const size_t size, BoardC board,
+                    enum Player* player) {
+  const char* cur = fen;
+  const char* const end = fen + size;
+  for (uint8_t row = 0; row < K_TOTAL_ROW; row++) {
+    if (row > 0) {
+      if (cur == end || *cur != '/') {
+        return false;
       }
-      return res;
+      cur++;
     }
-  } else {
-    if (pos < K_RED_RIVER_START &&
-        CAN_CAPTURE(board[pos + K_TOTAL_COL], is_red)) {
-      *out = pos + K_TOTAL_COL;
-      return 1;
-    } else {
-      if (pos < 81 && CAN_CAPTURE(board[pos + K_TOTAL_COL], is_red)) {
-        *(out + res++) = pos + K_TOTAL_COL;
-      }
-      const uint8_t col = Col(pos);
-      if (col > 0 && CAN_CAPTURE(board[pos - 1], is_red)) {
-        *(out + res++) = pos - 1;
+    Position pos = Pos(row, 0);
+    const Position row_end = pos + K_TOTAL_COL;
+    for (; cur != end && pos < row_end; cur++) {
+      const char ch = *cur;
+      if (ch >= '1' && ch <= '9') {
+        const uint8_t empty = ch - '0';
+        if (pos + empty > row_end) {
+          return false;
+        }
+        memset(board + pos, PIECE_EMPTY, empty);
+        pos += empty;
+        continue;
       }
-      if (col < K_TOTAL_COL - 1 && CAN_CAPTURE(board[pos + 1], is_red)) {
-        *(out + res++) = pos + 1;
+      const enum Piece piece = FenChToPiece(ch);
+      if (piece == PIECE_EMPTY) {
+        return false;
       }
-      return res;
+      board[pos++] = piece;
     }
-  }
-}
-
-// --------------- Public Function ---------------
-
-void BoardToString_C(const BoardC board, char out[K_BOARD_STR_SIZE]) {
-  out[K_BOARD_STR_SIZE - 1] = '\0';
-  strcpy(out, "  A B C D E F G H I \n");
-  out += 21;
-  for (uint8_t row = 0; row < K_TOTAL_ROW; row++) {
-    *(out++) = ('0' + row);
-    *(out++) = ' ';
-    for (uint8_t col = 0; col < K_TOTAL_COL; col++) {
-      *(out++) = PieceToCh(board[Pos(row, col)], row, col);
-      *(out++) = ' ';
+    if (pos != row_end) {
+      return false;
     }
-    *(out++) = '\n';
   }
+  if (cur != end && *cur != ' ') {
+    return false;
+  }
+  while (cur != end && *cur == ' ') {
+    cur++;
+  }
+  if (cur == end) {
+    *player = PLAYER_RED;
+    return true;
+  }
+  const bool red = *cur == 'w' || *cur == 'r';
+  if (!red && *cur != 'b') {
+    return false;
+  }
+  cur++;
+  *player = red ? PLAYER_RED : PLAYER_BLACK;
+  return cur == end || *cur == ' ';
 }
 
 void ClearBoard_C(BoardC board) { memset(board, 0, K_BOARD_SIZE); }
@@ -709,137 +513,113 @@ void CopyBoard_C(BoardC dest, const BoardC src) {
   memcpy(dest, src, K_BOARD_SIZE);
 }
 
+bool BoardEq_C(const BoardC a, const BoardC b) { return BoardsEqual(a, b); }
+
 Position FindGeneral_C(const BoardC board, const enum Player player) {
   const bool find_red = player == PLAYER_RED;
   const enum Piece general = find_red ? R_GENERAL : B_GENERAL;
-  if (find_red) {
-    // Find from bottom if find red.
-    if (board[66] == general) {
-      return 66;
-    } else if (board[67] == general) {
-      return 67;
-    } else if (board[68] == general) {
-      return 68;
-    } else if (board[75] == general) {
-      return 75;
-    } else if (board[76] == general) {
-      return 76;
-    } else if (board[77] == general) {
-      return 77;
-    } else if (board[84] == general) {
-      return 84;
-    } else if (board[85] == general) {
-      return 85;
-    } else if (board[86] == general) {
-      return 86;
-    } else if (board[3] == general) {
-      return 3;
-    } else if (board[4] == general) {
-      return 4;
-    } else if (board[5] == general) {
-      return 5;
-    } else if (board[12] == general) {
-      return 12;
-    } else if (board[13] == general) {
-      return 13;
-    } else if (board[14] == general) {
-      return 14;
-    } else if (board[21] == general) {
-      return 21;
-    } else if (board[22] == general) {
-      return 22;
-    } else if (board[23] == general) {
-      return 23;
-    }
-  } else {
-    // Find from top if find black.
-    if (board[3] == general) {
-      return 3;
-    } else if (board[4] == general) {
-      return 4;
-    } else if (board[5] == general) {
-      return 5;
-    } else if (board[12] == general) {
-      return 12;
-    } else if (board[13] == general) {
-      return 13;
-    } else if (board[14] == general) {
-      return 14;
-    } else if (board[21] == general) {
-      return 21;
-    } else if (board[22] == general) {
-      return 22;
-    } else if (board[23] == general) {
-      return 23;
-    } else if (board[66] == general) {
-      return 66;
-    } else if (board[67] == general) {
-      return 67;
-    } else if (board[68] == general) {
-      return 68;
-    } else if (board[75] == general) {
-      return 75;
-    } else if (board[76] == general) {
-      return 76;
-    } else if (board[77] == general) {
-      return 77;
-    } else if (board[84] == general) {
-      return 84;
-    } else if (board[85] == general) {
-      return 85;
-    } else if (board[86] == general) {
-      return 86;
+  // Own palace first.
+  const Position own = FindInPalace(board, find_red, general);
+  return own != K_NO_POSITION ? own : FindInPalace(board, !find_red, general);
+}
+
+bool IsSquareAttacked_C(const BoardC board, const Position pos,
+                        const enum Player by_player) {
+  return by_player == PLAYER_RED ? PlayerAttacks(board, pos, PLAYER_RED)
+                                 : PlayerAttacks(board, pos, PLAYER_BLACK);
+}
+
+void ComputeAttackMap_C(const BoardC board, const enum Player player,
+                        AttackMapC out) {
+  memset(out, 0, K_BOARD_SIZE);
+  const bool player_is_red = player == PLAYER_RED;
+  for (Position pos = 0; pos < K_BOARD_SIZE; pos++) {
+    const enum Piece piece = board[pos];
+    if (!IsEmpty(piece) && IsRed(piece) == player_is_red) {
+      AddPieceAttacks(board, pos, out);
     }
   }
-  return K_NO_POSITION;
 }
 
-bool IsBeingCheckmate_C(const BoardC board, const enum Player player) {
-  const Position general_pos = FindGeneral_C(board, player);
-  if (general_pos == K_NO_POSITION) {
+void ComputeGivesCheckInfo_C(const BoardC board, const enum Player player,
+                             GivesCheckInfoC* out) {
+  out->player = player;
+  out->general = FindGeneral_C(board, ChangePlayer(player));
+  out->attacked = out->general == K_NO_POSITION ||
+                  IsSquareAttacked_C(board, out->general, player);
+}
+
+bool MoveGivesCheck_C(const BoardC board, const GivesCheckInfoC* info,
+                      const Movement movement) {
+  const Position general = info->general;
+  const Position from = Orig(movement);
+  const Position to = Dest(movement);
+  if (general == K_NO_POSITION || to == general) {
     return true;
   }
+  // Other pieces only attack the general through its rank and file, and
+  // through horse legs next to it. If the move touches neither, only the
+  // moved piece can give a new check, and only a horse can do so from off
+  // the general's lines.
+  if (!info->attacked && !NearGeneral(general, from) &&
+      !NearGeneral(general, to)) {
+    const enum Piece piece = board[from];
+    return (piece == R_HORSE || piece == B_HORSE) &&
+           ThreatensByHorse(board, to, general);
+  }
+  return info->player == PLAYER_RED
+             ? PlayerAttacksAfterMove(board, general, PLAYER_RED, movement)
+             : PlayerAttacksAfterMove(board, general, PLAYER_BLACK, movement);
+}
 
-  // Now scan the board for enemy pieces that might be threatening our
-  // general.
-  for (uint8_t pos = 0; pos < K_BOARD_SIZE; pos++) {
-    const enum Piece piece = board[pos];
-    if (piece == PIECE_EMPTY) {
-      continue;
-    }
-    const bool piece_is_red = IsRed(piece);
-    const bool player_is_red = player == PLAYER_RED;
-    if (piece_is_red == player_is_red) {
-      continue;  // Skip own piece
+int32_t StaticExchangeEval_C(const BoardC board, const Movement movement) {
+  const Position from = Orig(movement);
+  const Position to = Dest(movement);
+  const enum Piece captured = board[to];
+  if (captured == R_GENERAL || captured == B_GENERAL) {
+    return K_PIECE_VALUES[R_GENERAL];
+  }
+  BoardC scratch;
+  CopyBoard_C(scratch, board);
+  // gains[i] is the material won by the side making the i-th capture,
+  // assuming the sequence stops right after it.
+  int32_t gains[K_TOTAL_PIECES + 1];
+  gains[0] = K_PIECE_VALUES[captured > 0 ? captured : -captured];
+  enum Piece on_target = scratch[from];
+  scratch[to] = on_target;
+  scratch[from] = PIECE_EMPTY;
+  enum Player player = IsRed(on_target) ? PLAYER_BLACK : PLAYER_RED;
+  uint8_t depth = 0;
+  while (depth < K_TOTAL_PIECES) {
+    const Position attacker =
+        LeastValuableAttacker(scratch, to, player, K_PIECE_VALUES);
+    if (attacker == K_NO_POSITION) {
+      break;
     }
-
-    switch (piece > 0 ? piece : -piece) {
-      case R_GENERAL:
-      case R_CHARIOT:
-        if (IsPathClear(board, pos, general_pos)) {
-          return true;
-        }
-        break;
-      case R_SOLDIER:
-        if (ThreatensBySoldier(piece, pos, general_pos)) {
-          return true;
-        }
-        break;
-      case R_HORSE:
-        if (ThreatensByHorse(board, pos, general_pos)) {
-          return true;
-        }
-        break;
-      case R_CANNON:
-        if (ThreatensByCannon(board, pos, general_pos)) {
-          return true;
-        }
-        break;
-      default:
-        continue;
+    depth++;
+    gains[depth] =
+        K_PIECE_VALUES[on_target > 0 ? on_target : -on_target] -
+        gains[depth - 1];
+    // Capturing the general ends the game.
+    if (on_target == R_GENERAL || on_target == B_GENERAL) {
+      break;
     }
+    on_target = scratch[attacker];
+    scratch[to] = on_target;
+    scratch[attacker] = PIECE_EMPTY;
+    player = ChangePlayer(player);
   }
-  return false;
+  // Each side only makes its capture if it is better than stopping before it.
+  for (; depth > 0; depth--) {
+    gains[depth - 1] = -(-gains[depth - 1] > gains[depth] ? -gains[depth - 1]
+                                                          : gains[depth]);
+  }
+  return gains[0];
+}
+
+bool IsBeingCheckmate_C(const BoardC board, const enum Player player) {
+  return player == PLAYER_RED ? PlayerIsThreatened(board, PLAYER_RED)
+                              : PlayerIsThreatened(board, PLAYER_BLACK);
 }
 
 enum Winner GetWinner_C(const BoardC board) {
@@ -855,6 +635,15 @@ enum Winner GetWinner_C(const BoardC board) {
 }
 
 enum Piece Move_C(BoardC board, const Movement movement) {
+  MoveUndoC undo;
+  return MakeMove_C(board, movement, &undo);
+}
+
+enum Piece MakeMove_C(BoardC board, const Movement movement,
+                      MoveUndoC* undo) {
+  undo->movement = K_NO_MOVEMENT;
+  undo->captured = PIECE_EMPTY;
+  undo->captured_index = K_NO_PIECE_INDEX;
   if (movement == K_NO_MOVEMENT) {
     return PIECE_EMPTY;
   }
@@ -870,418 +659,206 @@ enum Piece Move_C(BoardC board, const Movement movement) {
   const enum Piece captured = board[to];
   board[to] = piece;
   board[from] = PIECE_EMPTY;
+  undo->movement = movement;
+  undo->captured = captured;
   return captured;
 }
 
+void UnmakeMove_C(BoardC board, const MoveUndoC* undo) {
+  if (undo->movement == K_NO_MOVEMENT) {
+    return;
+  }
+  const Position from = Orig(undo->movement);
+  const Position to = Dest(undo->movement);
+  board[from] = board[to];
+  board[to] = undo->captured;
+}
+
+uint64_t ZobristKey_C(const BoardC board, const enum Player player) {
+  uint64_t res = player == PLAYER_BLACK ? K_ZOBRIST_TABLES.black_to_move : 0;
+  for (Position pos = 0; pos < K_BOARD_SIZE; pos++) {
+    res ^= ZobristPieceKey(board[pos], pos);
+  }
+  return res;
+}
+
+uint64_t ZobristMoveKey_C(uint64_t key, const enum Piece piece,
+                          const enum Piece captured, const Movement movement) {
+  key ^= K_ZOBRIST_TABLES.black_to_move;
+  if (movement == K_NO_MOVEMENT || piece == PIECE_EMPTY) {
+    return key;
+  }
+  const Position from = Orig(movement);
+  const Position to = Dest(movement);
+  if (from == to) {
+    return key;
+  }
+  return key ^ ZobristPieceKey(piece, from) ^ ZobristPieceKey(piece, to) ^
+         ZobristPieceKey(captured, to);
+}
+
+uint64_t ZobristMirrorKey_C(const BoardC board, const enum Player player) {
+  uint64_t res = player == PLAYER_BLACK ? K_ZOBRIST_TABLES.black_to_move : 0;
+  for (Position row_start = 0; row_start < K_BOARD_SIZE;
+       row_start += K_TOTAL_COL) {
+    for (uint8_t col = 0; col < K_TOTAL_COL; col++) {
+      res ^= ZobristPieceKey(board[row_start + col],
+                             row_start + K_TOTAL_COL - 1 - col);
+    }
+  }
+  return res;
+}
+
+uint64_t ZobristMirrorMoveKey_C(const uint64_t mirror_key,
+                                const enum Piece piece,
+                                const enum Piece captured,
+                                const Movement movement) {
+  return ZobristMoveKey_C(mirror_key, piece, captured,
+                          MirrorMovementHorizontal(movement));
+}
+
+CanonicalKeyC SelectCanonicalKey_C(const uint64_t key,
+                                   const uint64_t mirror_key) {
+  CanonicalKeyC res;
+  res.mirrored = mirror_key < key;
+  res.key = res.mirrored ? mirror_key : key;
+  return res;
+}
+
+CanonicalKeyC CanonicalZobristKey_C(const BoardC board,
+                                    const enum Player player) {
+  uint64_t key = player == PLAYER_BLACK ? K_ZOBRIST_TABLES.black_to_move : 0;
+  uint64_t mirror_key = key;
+  for (Position row_start = 0; row_start < K_BOARD_SIZE;
+       row_start += K_TOTAL_COL) {
+    for (uint8_t col = 0; col < K_TOTAL_COL; col++) {
+      const enum Piece piece = board[row_start + col];
+      key ^= ZobristPieceKey(piece, row_start + col);
+      mirror_key ^= ZobristPieceKey(piece, row_start + K_TOTAL_COL - 1 - col);
+    }
+  }
+  return SelectCanonicalKey_C(key, mirror_key);
+}
+
 void FlipBoard_C(BoardC dest, const BoardC src) {
+#if defined(__SSSE3__)
+  TransformBoard(dest, src, &K_FLIP_TRANSFORM);
+#else
   for (uint8_t pos = 0; pos < K_BOARD_SIZE / 2; pos++) {
     const uint8_t pos_mirror = K_BOARD_SIZE - 1 - pos;
     const enum Piece left_flipped = -src[pos];
     dest[pos] = -src[pos_mirror];
     dest[pos_mirror] = left_flipped;
   }
+#endif
 }
 
 void MirrorBoardHorizontal_C(BoardC dest, const BoardC src) {
+#if defined(__SSSE3__)
+  TransformBoard(dest, src, &K_MIRROR_HORIZONTAL_TRANSFORM);
+#else
   for (uint8_t row = 0; row < K_TOTAL_ROW; row++) {
     const Position row_start = row * K_TOTAL_COL;
     for (uint8_t col = 0; col < K_TOTAL_COL / 2; col++) {
       const Position left_pos = row_start + col;
       const Position right_pos = row_start + K_TOTAL_COL - 1 - col;
+      const enum Piece left = src[left_pos];
       dest[left_pos] = src[right_pos];
-      dest[right_pos] = src[left_pos];
+      dest[right_pos] = left;
     }
     dest[row_start + K_TOTAL_COL / 2] = src[row_start + K_TOTAL_COL / 2];
   }
+#endif
 }
 
 void MirrorBoardVertical_C(BoardC dest, const BoardC src) {
+#if defined(__SSSE3__)
+  TransformBoard(dest, src, &K_MIRROR_VERTICAL_TRANSFORM);
+#else
   for (uint8_t row = 0; row < K_TOTAL_ROW / 2; row++) {
-    const size_t top_start = row * K_TOTAL_COL;
-    const size_t bottom_start = (K_TOTAL_ROW - 1 - row) * K_TOTAL_COL;
-    memcpy((void*)dest + top_start, (void*)src + bottom_start, K_TOTAL_COL);
-    memcpy((void*)dest + bottom_start, (void*)src + top_start, K_TOTAL_COL);
+    const Position top_start = row * K_TOTAL_COL;
+    const Position bottom_start = (K_TOTAL_ROW - 1 - row) * K_TOTAL_COL;
     for (uint8_t col = 0; col < K_TOTAL_COL; col++) {
-      dest[top_start + col] = -dest[top_start + col];
-      dest[bottom_start + col] = -dest[bottom_start + col];
+      const enum Piece top = src[top_start + col];
+      dest[top_start + col] = -src[bottom_start + col];
+      dest[bottom_start + col] = -top;
     }
   }
+#endif
 }
 
 void EncodeBoardState_C(const BoardC board, BoardStateC out) {
-  uint64_t res1 = 0, res2 = 0, res3 = 0, res4 = 0;
-
-  // Initialize all pieces as missing.
-  uint8_t r_general_pos = 0xFF, b_general_pos = 0xFF;
-  uint16_t r_advisor_poses = 0xFFFF, r_elephant_poses = 0xFFFF,
-           r_horse_poses = 0xFFFF, r_chariot_poses = 0xFFFF,
-           r_cannon_poses = 0xFFFF, b_advisor_poses = 0xFFFF,
-           b_elephant_poses = 0xFFFF, b_horse_poses = 0xFFFF,
-           b_chariot_poses = 0xFFFF, b_cannon_poses = 0xFFFF;
-
-  uint8_t r_soldier_poses[5];
-  uint8_t b_soldier_poses[5];
-  uint8_t r_soldier_idx = 0, b_soldier_idx = 0;
-
-  for (Position pos = 0; pos < K_BOARD_SIZE; pos++) {
-    switch (board[pos]) {
-      case PIECE_EMPTY: {
-        continue;
-      }
-      case R_GENERAL: {
-        r_general_pos = pos;
-        break;
-      }
-      case B_GENERAL: {
-        b_general_pos = pos;
-        break;
-      }
-      case R_ADVISOR: {
-        const uint16_t left_byte = r_advisor_poses & 0xFF00;
-        const uint16_t cur_min = left_byte >> 8;
-        r_advisor_poses = (pos < cur_min) ? ((((uint16_t)pos) << 8) | cur_min)
-                                          : (left_byte | pos);
-        break;
-      }
-      case B_ADVISOR: {
-        const uint16_t left_byte = b_advisor_poses & 0xFF00;
-        const uint16_t cur_min = left_byte >> 8;
-        b_advisor_poses = (pos < cur_min) ? ((((uint16_t)pos) << 8) | cur_min)
-                                          : (left_byte | pos);
-        break;
-      }
-      case R_ELEPHANT: {
-        const uint16_t left_byte = r_elephant_poses & 0xFF00;
-        const uint16_t cur_min = left_byte >> 8;
-        r_elephant_poses = (pos < cur_min) ? ((((uint16_t)pos) << 8) | cur_min)
-                                           : (left_byte | pos);
-        break;
-      }
-      case B_ELEPHANT: {
-        const uint16_t left_byte = b_elephant_poses & 0xFF00;
-        const uint16_t cur_min = left_byte >> 8;
-        b_elephant_poses = (pos < cur_min) ? ((((uint16_t)pos) << 8) | cur_min)
-                                           : (left_byte | pos);
-        break;
-      }
-      case R_HORSE: {
-        const uint16_t left_byte = r_horse_poses & 0xFF00;
-        const uint16_t cur_min = left_byte >> 8;
-        r_horse_poses = (pos < cur_min) ? ((((uint16_t)pos) << 8) | cur_min)
-                                        : (left_byte | pos);
-        break;
-      }
-      case B_HORSE: {
-        const uint16_t left_byte = b_horse_poses & 0xFF00;
-        const uint16_t cur_min = left_byte >> 8;
-        b_horse_poses = (pos < cur_min) ? ((((uint16_t)pos) << 8) | cur_min)
-                                        : (left_byte | pos);
-        break;
-      }
-      case R_CHARIOT: {
-        const uint16_t left_byte = r_chariot_poses & 0xFF00;
-        const uint16_t cur_min = left_byte >> 8;
-        r_chariot_poses = (pos < cur_min) ? ((((uint16_t)pos) << 8) | cur_min)
-                                          : (left_byte | pos);
-        break;
-      }
-      case B_CHARIOT: {
-        const uint16_t left_byte = b_chariot_poses & 0xFF00;
-        const uint16_t cur_min = left_byte >> 8;
-        b_chariot_poses = (pos < cur_min) ? ((((uint16_t)pos) << 8) | cur_min)
-                                          : (left_byte | pos);
-        break;
-      }
-      case R_CANNON: {
-        const uint16_t left_byte = r_cannon_poses & 0xFF00;
-        const uint16_t cur_min = left_byte >> 8;
-        r_cannon_poses = (pos < cur_min) ? ((((uint16_t)pos) << 8) | cur_min)
-                                         : (left_byte | pos);
-        break;
-      }
-      case B_CANNON: {
-        const uint16_t left_byte = b_cannon_poses & 0xFF00;
-        const uint16_t cur_min = left_byte >> 8;
-        b_cannon_poses = (pos < cur_min) ? ((((uint16_t)pos) << 8) | cur_min)
-                                         : (left_byte | pos);
-        break;
-      }
-      case R_SOLDIER:
-        r_soldier_poses[r_soldier_idx++] = pos;
-        break;
-      case B_SOLDIER:
-        b_soldier_poses[b_soldier_idx++] = pos;
-        break;
-    }
-  }
-
-  for (uint8_t i = r_soldier_idx; i < 5; i++) {
-    r_soldier_poses[i] = K_NO_POSITION;
-  }
-
-  for (uint8_t i = b_soldier_idx; i < 5; i++) {
-    b_soldier_poses[i] = K_NO_POSITION;
-  }
-
-  res1 |= ((uint64_t)r_general_pos) << (7 * 8);
-  res3 |= ((uint64_t)b_general_pos) << (7 * 8);
-  res1 |= ((uint64_t)r_advisor_poses) << (5 * 8);
-  res3 |= ((uint64_t)b_advisor_poses) << (5 * 8);
-  res1 |= ((uint64_t)r_elephant_poses) << (3 * 8);
-  res3 |= ((uint64_t)b_elephant_poses) << (3 * 8);
-  res1 |= ((uint64_t)r_horse_poses) << 8;
-  res3 |= ((uint64_t)b_horse_poses) << 8;
-  res1 |= (uint64_t)(r_chariot_poses >> 8);
-  res3 |= (uint64_t)(b_chariot_poses >> 8);
-
-  res2 |= (uint64_t)(r_chariot_poses & 0x00FF) << (7 * 8);
-  res4 |= (uint64_t)(b_chariot_poses & 0x00FF) << (7 * 8);
-
-  res2 |= ((uint64_t)r_cannon_poses) << (5 * 8);
-  res4 |= ((uint64_t)b_cannon_poses) << (5 * 8);
-
-  res2 |= ((uint64_t)(r_soldier_poses[0]) << (4 * 8)) |
-          ((uint64_t)(r_soldier_poses[1]) << (3 * 8)) |
-          ((uint64_t)(r_soldier_poses[2]) << (2 * 8)) |
-          ((uint64_t)(r_soldier_poses[3]) << 8) |
-          (uint64_t)(r_soldier_poses[4]);
-  res4 |= ((uint64_t)(b_soldier_poses[0]) << (4 * 8)) |
-          ((uint64_t)(b_soldier_poses[1]) << (3 * 8)) |
-          ((uint64_t)(b_soldier_poses[2]) << (2 * 8)) |
-          ((uint64_t)(b_soldier_poses[3]) << 8) |
-          (uint64_t)(b_soldier_poses[4]);
-
-  out[0] = res1;
-  out[1] = res2;
-  out[2] = res3;
-  out[3] = res4;
+  uint8_t bytes[K_BOARD_STATE_BYTES];
+  memset(bytes, K_NO_POSITION, sizeof(bytes));
+  uint8_t next[K_TOTAL_PIECE_VALUES];
+  memcpy(next, K_STATE_FIRST_SLOT, sizeof(next));
+  // Pieces are visited in increasing positions, so each kind's slots are
+  // filled in sorted order.
+  BitboardC occupied = BoardOccupancyMask(board);
+  while (occupied != K_EMPTY_BITBOARD) {
+    const Position pos = BitboardPop(&occupied);
+    const uint8_t idx = board[pos] + R_SOLDIER;
+    const uint8_t slot = next[idx];
+    bytes[slot] = pos;
+    // Extra pieces of a kind keep overwriting its last slot.
+    next[idx] += slot < K_STATE_LAST_SLOT[idx];
+  }
+  BytesToState(bytes, K_BOARD_STATE_BYTES, out);
 }
 
-// Decode the encoded board state back to its original state.
 void DecodeBoardState_C(const BoardStateC state, BoardC out) {
   ClearBoard_C(out);
-
-  // For red pieces, the encoded state is split between state[0] (res1) and
-  // state[1] (res2).
-  uint64_t res1 = state[0];
-  uint64_t res2 = state[1];
-
-  // --- Red Pieces ---
-
-  // Red General: bits 56-63 of res1.
-  uint8_t r_general = (res1 >> 56) & 0xFF;
-  if (r_general != 0xFF) {
-    out[r_general] = R_GENERAL;
-  }
-
-  // Red Advisors: bits 48-55 and 40-47 of res1.
-  uint8_t r_adv1 = (res1 >> 48) & 0xFF;
-  if (r_adv1 != 0xFF) {
-    out[r_adv1] = R_ADVISOR;
-  }
-  uint8_t r_adv2 = (res1 >> 40) & 0xFF;
-  if (r_adv2 != 0xFF) {
-    out[r_adv2] = R_ADVISOR;
-  }
-
-  // Red Elephants: bits 32-39 and 24-31 of res1.
-  uint8_t r_ele1 = (res1 >> 32) & 0xFF;
-  if (r_ele1 != 0xFF) {
-    out[r_ele1] = R_ELEPHANT;
-  }
-  uint8_t r_ele2 = (res1 >> 24) & 0xFF;
-  if (r_ele2 != 0xFF) {
-    out[r_ele2] = R_ELEPHANT;
-  }
-
-  // Red Horses: bits 16-23 and 8-15 of res1.
-  uint8_t r_horse1 = (res1 >> 16) & 0xFF;
-  if (r_horse1 != 0xFF) {
-    out[r_horse1] = R_HORSE;
-  }
-  uint8_t r_horse2 = (res1 >> 8) & 0xFF;
-  if (r_horse2 != 0xFF) {
-    out[r_horse2] = R_HORSE;
-  }
-
-  // Red Chariots:
-  //   - One chariot: bits 0-7 of res1.
-  uint8_t r_chariot1 = res1 & 0xFF;
-  if (r_chariot1 != 0xFF) {
-    out[r_chariot1] = R_CHARIOT;
-  }
-  //   - The other chariot: bits 56-63 of res2.
-  uint8_t r_chariot2 = (res2 >> 56) & 0xFF;
-  if (r_chariot2 != 0xFF) {
-    out[r_chariot2] = R_CHARIOT;
-  }
-
-  // Red Cannons: bits 48-55 and 40-47 of res2.
-  uint8_t r_cannon1 = (res2 >> 48) & 0xFF;
-  if (r_cannon1 != 0xFF) {
-    out[r_cannon1] = R_CANNON;
-  }
-  uint8_t r_cannon2 = (res2 >> 40) & 0xFF;
-  if (r_cannon2 != 0xFF) {
-    out[r_cannon2] = R_CANNON;
-  }
-
-  // Red Soldiers: bits 32-39, 24-31, 16-23, 8-15, and 0-7 of res2.
-  uint8_t r_soldier[5];
-  r_soldier[0] = (res2 >> 32) & 0xFF;
-  r_soldier[1] = (res2 >> 24) & 0xFF;
-  r_soldier[2] = (res2 >> 16) & 0xFF;
-  r_soldier[3] = (res2 >> 8) & 0xFF;
-  r_soldier[4] = res2 & 0xFF;
-  for (int i = 0; i < 5; ++i) {
-    if (r_soldier[i] != 0xFF) {
-      const Position pos = r_soldier[i];
-      out[pos] = R_SOLDIER;
+  for (uint8_t word = 0; word < K_BOARD_STATE_BYTES / 8; word++) {
+    for (uint8_t i = 0; i < 8; i++) {
+      const Position pos = (uint8_t)(state[word] >> (56 - 8 * i));
+      if (pos < K_BOARD_SIZE) {
+        out[pos] = K_STATE_SLOT_PIECES[word * 8 + i];
+      }
     }
   }
+}
 
-  // For black pieces, the encoded state is in state[2] (res3) and state[3]
-  // (res4).
-  uint64_t res3 = state[2];
-  uint64_t res4 = state[3];
-
-  // --- Black Pieces ---
-
-  // Black General: bits 56-63 of res3.
-  uint8_t b_general = (res3 >> 56) & 0xFF;
-  if (b_general != 0xFF) {
-    out[b_general] = B_GENERAL;
-  }
-
-  // Black Advisors: bits 48-55 and 40-47 of res3.
-  uint8_t b_adv1 = (res3 >> 48) & 0xFF;
-  if (b_adv1 != 0xFF) {
-    out[b_adv1] = B_ADVISOR;
-  }
-  uint8_t b_adv2 = (res3 >> 40) & 0xFF;
-  if (b_adv2 != 0xFF) {
-    out[b_adv2] = B_ADVISOR;
-  }
-
-  // Black Elephants: bits 32-39 and 24-31 of res3.
-  uint8_t b_ele1 = (res3 >> 32) & 0xFF;
-  if (b_ele1 != 0xFF) {
-    out[b_ele1] = B_ELEPHANT;
-  }
-  uint8_t b_ele2 = (res3 >> 24) & 0xFF;
-  if (b_ele2 != 0xFF) {
-    out[b_ele2] = B_ELEPHANT;
-  }
-
-  // Black Horses: bits 16-23 and 8-15 of res3.
-  uint8_t b_horse1 = (res3 >> 16) & 0xFF;
-  if (b_horse1 != 0xFF) {
-    out[b_horse1] = B_HORSE;
-  }
-  uint8_t b_horse2 = (res3 >> 8) & 0xFF;
-  if (b_horse2 != 0xFF) {
-    out[b_horse2] = B_HORSE;
-  }
-
-  // Black Chariots:
-  //   - One from res3: bits 0-7.
-  uint8_t b_chariot1 = res3 & 0xFF;
-  if (b_chariot1 != 0xFF) {
-    out[b_chariot1] = B_CHARIOT;
-  }
-  //   - The other from res4: bits 56-63.
-  uint8_t b_chariot2 = (res4 >> 56) & 0xFF;
-  if (b_chariot2 != 0xFF) {
-    out[b_chariot2] = B_CHARIOT;
-  }
-
-  // Black Cannons: bits 48-55 and 40-47 of res4.
-  uint8_t b_cannon1 = (res4 >> 48) & 0xFF;
-  if (b_cannon1 != 0xFF) {
-    out[b_cannon1] = B_CANNON;
-  }
-  uint8_t b_cannon2 = (res4 >> 40) & 0xFF;
-  if (b_cannon2 != 0xFF) {
-    out[b_cannon2] = B_CANNON;
+void BoardStateMove_C(BoardStateC state, const enum Piece piece,
+                      const enum Piece captured, const Movement movement) {
+  if (movement == K_NO_MOVEMENT || piece == PIECE_EMPTY ||
+      Orig(movement) == Dest(movement)) {
+    return;
   }
+  MovePieceInState(state, captured, Dest(movement), K_NO_POSITION);
+  MovePieceInState(state, piece, Orig(movement), Dest(movement));
+}
 
-  // Black Soldiers: bits 32-39, 24-31, 16-23, 8-15, and 0-7 of res4.
-  uint8_t b_soldier[5];
-  b_soldier[0] = (res4 >> 32) & 0xFF;
-  b_soldier[1] = (res4 >> 24) & 0xFF;
-  b_soldier[2] = (res4 >> 16) & 0xFF;
-  b_soldier[3] = (res4 >> 8) & 0xFF;
-  b_soldier[4] = res4 & 0xFF;
-  for (int i = 0; i < 5; ++i) {
-    if (b_soldier[i] != 0xFF) {
-      const Position pos = b_soldier[i];
-      out[pos] = B_SOLDIER;
-    }
+void BoardStateUnmove_C(BoardStateC state, const enum Piece piece,
+                        const enum Piece captured, const Movement movement) {
+  if (movement == K_NO_MOVEMENT || piece == PIECE_EMPTY ||
+      Orig(movement) == Dest(movement)) {
+    return;
   }
+  MovePieceInState(state, piece, Dest(movement), Orig(movement));
+  MovePieceInState(state, captured, K_NO_POSITION, Dest(movement));
 }
 
 uint8_t PossiblePositions_C(const BoardC board, const Position pos,
                             const bool avoid_checkmate, MovesPerPieceC out) {
   memset(out, 0xFF, K_MAX_MOVE_PER_PIECE);
-  uint8_t res = 0;
-
   const enum Piece piece = board[pos];
-  switch (piece) {
-    case PIECE_EMPTY:
-      return res;
-    case R_GENERAL:
-      res = PossiblePositionsGeneral(board, pos,
-                                     FindGeneral_C(board, PLAYER_BLACK), out);
-      break;
-    case B_GENERAL:
-      res = PossiblePositionsGeneral(board, pos,
-                                     FindGeneral_C(board, PLAYER_RED), out);
-      break;
-    case R_ADVISOR:
-    case B_ADVISOR:
-      res = PossiblePositionsAdvisor(board, pos, out);
-      break;
-    case R_ELEPHANT:
-    case B_ELEPHANT:
-      res = PossiblePositionsElephant(board, pos, out);
-      break;
-    case R_HORSE:
-    case B_HORSE:
-      res = PossiblePositionsHorse(board, pos, out);
-      break;
-    case R_CHARIOT:
-    case B_CHARIOT:
-      res = PossiblePositionsChariot(board, pos, out);
-      break;
-    case R_CANNON:
-    case B_CANNON:
-      res = PossiblePositionsCannon(board, pos, out);
-      break;
-    case R_SOLDIER:
-    case B_SOLDIER:
-      res = PossiblePositionsSoldier(board, pos, out);
-      break;
-    default:
-      return res;
-  }
+  if (piece == PIECE_EMPTY) {
+    return 0;
+  }
+  uint8_t res = PseudoPossiblePositions(
+      board, pos,
+      piece == R_GENERAL   ? FindGeneral_C(board, PLAYER_BLACK)
+      : piece == B_GENERAL ? FindGeneral_C(board, PLAYER_RED)
+                           : K_NO_POSITION,
+      out);
   if (avoid_checkmate) {
     const enum Player player = IsRed(piece) ? PLAYER_RED : PLAYER_BLACK;
-    for (size_t i = 0; i < res && *(out + i) != K_NO_POSITION; i++) {
-      BoardC next;
-      CopyBoard_C(next, board);
-      const enum Piece captured = Move_C(next, NewMovement(pos, *(out + i)));
-      if (captured == R_GENERAL || captured == B_GENERAL) {
-        continue;
-      }
-      if (IsBeingCheckmate_C(next, player)) {
-        // Replace the current result with the last one, and set the last one
-        // to no position.
-        *(out + i) = *(out + res - 1);
-        *(out + res - 1) = K_NO_POSITION;
-        res--;
-        i--;
-      }
-    }
+    CheckInfoC info = {0};
+    ComputeBoardCheckInfo(board, player, &info);
+    // Moves are made and taken back in place on a single copy of the board.
+    BoardC scratch;
+    CopyBoard_C(scratch, board);
+    res = FilterLegalPositions(scratch, player, &info, pos, out, res);
   }
   return res;
 }
@@ -1289,17 +866,51 @@ uint8_t PossiblePositions_C(const BoardC board, const Position pos,
 uint8_t PossibleMoves_C(const BoardC board, const enum Player player,
                         const bool avoid_checkmate, MaxMovesPerPlayerC out) {
   memset(out, 0xFFFF, K_MAX_MOVE_PER_PLAYER * sizeof(Movement));
+  return PossibleMovesOfKind(board, player, avoid_checkmate, MOVE_KIND_ALL,
+                             out);
+}
+
+uint8_t PossibleCaptures_C(const BoardC board, const enum Player player,
+                           const bool avoid_checkmate, MaxMovesPerPlayerC out) {
+  return PossibleMovesOfKind(board, player, avoid_checkmate,
+                             MOVE_KIND_CAPTURES, out);
+}
+
+uint8_t PossibleQuietMoves_C(const BoardC board, const enum Player player,
+                             const bool avoid_checkmate,
+                             MaxMovesPerPlayerC out) {
+  return PossibleMovesOfKind(board, player, avoid_checkmate, MOVE_KIND_QUIETS,
+                             out);
+}
+
+uint8_t PossibleEvasions_C(const BoardC board, const enum Player player,
+                           MaxMovesPerPlayerC out) {
+  const Position general = FindGeneral_C(board, player);
+  const Position opponent_general = FindGeneral_C(board, ChangePlayer(player));
+  const bool player_is_red = player == PLAYER_RED;
+  BitboardC evasion_to;
+  BitboardC evasion_from;
+  ComputeEvasionTargets(board, player, general, opponent_general, &evasion_to,
+                        &evasion_from);
+
+  BoardC scratch;
+  CopyBoard_C(scratch, board);
   uint8_t res = 0;
   MovesPerPieceC buff;
-  for (uint8_t pos = 0; pos < K_BOARD_SIZE; pos++) {
+  for (Position pos = 0; pos < K_BOARD_SIZE; pos++) {
     const enum Piece piece = board[pos];
-    if (IsEmpty(piece) || ((player == PLAYER_RED) != (piece > 0))) {
+    if (IsEmpty(piece) || IsRed(piece) != player_is_red) {
       continue;
     }
+    const bool any_dest = pos == general || BitboardHas(evasion_from, pos);
     const uint8_t num_moves =
-        PossiblePositions_C(board, pos, avoid_checkmate, buff);
-    for (uint8_t i = 0; i < num_moves; ++i) {
-      *(out + res++) = NewMovement(pos, buff[i]);
+        PseudoPossiblePositions(board, pos, opponent_general, buff);
+    for (uint8_t i = 0; i < num_moves; i++) {
+      const Movement movement = NewMovement(pos, buff[i]);
+      if ((any_dest || BitboardHas(evasion_to, buff[i])) &&
+          IsLegalMove(scratch, player, movement)) {
+        *(out + res++) = movement;
+      }
     }
   }
   return res;
@@ -1319,133 +930,85 @@ uint8_t PossibleBoards_C(const BoardC board, const enum Player player,
   return res;
 }
 
-bool DidPlayerLose_C(const BoardC board, const enum Player player) {
-  const enum Winner opponent = player == PLAYER_RED ? WINNER_BLACK : WINNER_RED;
-  const enum Piece opponent_general =
-      player == PLAYER_RED ? B_GENERAL : R_GENERAL;
-  if (GetWinner_C(board) == opponent) {
-    return true;
+uint8_t StartChildBoards_C(const BoardC board, const enum Player player,
+                           const bool avoid_checkmate, ChildBoardsC* children) {
+  children->num_moves = PossibleMovesOfKind(board, player, avoid_checkmate,
+                                            MOVE_KIND_ALL, children->moves);
+  children->next = 0;
+  return children->num_moves;
+}
+
+bool NextChildBoard_C(BoardC board, ChildBoardsC* children) {
+  // next is num_moves + 1 once the walk ended.
+  if (children->next > children->num_moves) {
+    return false;
+  }
+  if (children->next > 0) {
+    UnmakeMove_C(board, &children->undo);
+  }
+  if (children->next == children->num_moves) {
+    children->next++;
+    return false;
+  }
+  MakeMove_C(board, children->moves[children->next++], &children->undo);
+  return true;
+}
+
+void StopChildBoards_C(BoardC board, ChildBoardsC* children) {
+  if (children->next > 0 && children->next <= children->num_moves) {
+    UnmakeMove_C(board, &children->undo);
   }
+  children->next = children->num_moves + 1;
+}
 
-  MovesPerPieceC buff;
-  for (Position pos = 0; pos < K_BOARD_SIZE; pos++) {
-    const enum Piece piece = board[pos];
-    if (piece == PIECE_EMPTY || IsRed(piece) != (player == PLAYER_RED)) {
-      continue;
-    }
-    switch (piece) {
-      case R_GENERAL:
-        for (uint8_t i = 0;
-             i < PossiblePositionsGeneral(
-                     board, pos, FindGeneral_C(board, PLAYER_BLACK), buff);
-             i++) {
-          BoardC next;
-          CopyBoard_C(next, board);
-          const enum Piece capture = Move_C(next, NewMovement(pos, buff[i]));
-          if (capture == opponent_general ||
-              !IsBeingCheckmate_C(next, player)) {
-            return false;
-          }
-        }
-        break;
-      case B_GENERAL:
-        for (uint8_t i = 0;
-             i < PossiblePositionsGeneral(
-                     board, pos, FindGeneral_C(board, PLAYER_RED), buff);
-             i++) {
-          BoardC next;
-          CopyBoard_C(next, board);
-          const enum Piece capture = Move_C(next, NewMovement(pos, buff[i]));
-          if (capture == opponent_general ||
-              !IsBeingCheckmate_C(next, player)) {
-            return false;
-          }
-        }
-        break;
-      case R_ADVISOR:
-      case B_ADVISOR:
-        for (uint8_t i = 0; i < PossiblePositionsAdvisor(board, pos, buff);
-             i++) {
-          BoardC next;
-          CopyBoard_C(next, board);
-          const enum Piece capture = Move_C(next, NewMovement(pos, buff[i]));
-          if (capture == opponent_general ||
-              !IsBeingCheckmate_C(next, player)) {
-            return false;
-          }
-        }
-        break;
-      case R_ELEPHANT:
-      case B_ELEPHANT:
-        for (uint8_t i = 0; i < PossiblePositionsElephant(board, pos, buff);
-             i++) {
-          BoardC next;
-          CopyBoard_C(next, board);
-          const enum Piece capture = Move_C(next, NewMovement(pos, buff[i]));
-          if (capture == opponent_general ||
-              !IsBeingCheckmate_C(next, player)) {
-            return false;
-          }
-        }
-        break;
-      case R_HORSE:
-      case B_HORSE:
-        for (uint8_t i = 0; i < PossiblePositionsHorse(board, pos, buff); i++) {
-          BoardC next;
-          CopyBoard_C(next, board);
-          const enum Piece capture = Move_C(next, NewMovement(pos, buff[i]));
-          if (capture == opponent_general ||
-              !IsBeingCheckmate_C(next, player)) {
-            return false;
-          }
-        }
-        break;
-      case R_CHARIOT:
-      case B_CHARIOT:
-        for (uint8_t i = 0; i < PossiblePositionsChariot(board, pos, buff);
-             i++) {
-          BoardC next;
-          CopyBoard_C(next, board);
-          const enum Piece capture = Move_C(next, NewMovement(pos, buff[i]));
-          if (capture == opponent_general ||
-              !IsBeingCheckmate_C(next, player)) {
-            return false;
-          }
-        }
-        break;
-      case R_CANNON:
-      case B_CANNON:
-        for (uint8_t i = 0; i < PossiblePositionsCannon(board, pos, buff);
-             i++) {
-          BoardC next;
-          CopyBoard_C(next, board);
-          const enum Piece capture = Move_C(next, NewMovement(pos, buff[i]));
-          if (capture == opponent_general ||
-              !IsBeingCheckmate_C(next, player)) {
-            return false;
-          }
-        }
-        break;
-      case R_SOLDIER:
-      case B_SOLDIER:
-        for (uint8_t i = 0; i < PossiblePositionsSoldier(board, pos, buff);
-             i++) {
-          BoardC next;
-          CopyBoard_C(next, board);
-          const enum Piece capture = Move_C(next, NewMovement(pos, buff[i]));
-          if (capture == opponent_general ||
-              !IsBeingCheckmate_C(next, player)) {
-            return false;
-          }
-        }
-        break;
-      default:
-        continue;
+uint32_t BatchPossibleMoves_C(const enum Piece* boards,
+                              const enum Player* players,
+                              const uint32_t num_boards,
+                              const bool avoid_checkmate, Movement* moves_out,
+                              uint32_t* offsets_out) {
+  uint32_t res = 0;
+  for (uint32_t i = 0; i < num_boards; i++) {
+    offsets_out[i] = res;
+    res += PossibleMovesOfKind(boards + i * K_BOARD_SIZE, players[i],
+                               avoid_checkmate, MOVE_KIND_ALL, moves_out + res);
+  }
+  offsets_out[num_boards] = res;
+  return res;
+}
+
+void BatchPossibleBoards_C(const enum Piece* boards, const uint32_t num_boards,
+                           const Movement* moves, const uint32_t* offsets,
+                           enum Piece* boards_out) {
+  for (uint32_t i = 0; i < num_boards; i++) {
+    const enum Piece* board = boards + i * K_BOARD_SIZE;
+    for (uint32_t j = offsets[i]; j < offsets[i + 1]; j++) {
+      enum Piece* out_start = boards_out + j * K_BOARD_SIZE;
+      CopyBoard_C(out_start, board);
+      Move_C(out_start, moves[j]);
     }
   }
-  return true;
 }
 
-#undef CAN_CAPTURE
-#undef MIN
-#undef MAX
+bool HasAnyLegalMove_C(const BoardC board, const enum Player player) {
+  const Position general = FindGeneral_C(board, player);
+  const Position opponent_general = FindGeneral_C(board, ChangePlayer(player));
+  return player == PLAYER_RED
+             ? PlayerHasLegalMove(board, PLAYER_RED, general, opponent_general)
+             : PlayerHasLegalMove(board, PLAYER_BLACK, general,
+                                  opponent_general);
+}
+
+bool DidPlayerLose_C(const BoardC board, const enum Player player) {
+  const Position general = FindGeneral_C(board, player);
+  const Position opponent_general = FindGeneral_C(board, ChangePlayer(player));
+  // Same as GetWinner_C returning the opponent, red wins if both generals are
+  // captured.
+  if (general == K_NO_POSITION &&
+      (opponent_general != K_NO_POSITION || player == PLAYER_BLACK)) {
+    return true;
+  }
+  return player == PLAYER_RED
+             ? !PlayerHasLegalMove(board, PLAYER_RED, general, opponent_general)
+             : !PlayerHasLegalMove(board, PLAYER_BLACK, general,
+                                   opponent_general);
+}
@@ -3,7 +3,6 @@
 #include <cstdint>
 #include <string>
 #include <string_view>
-#include <utility>
 #include <vector>
 
 #include "xiangqi/board_c.h"
@@ -72,13 +71,18 @@ std::string BoardToString(const Board& board) {
   return {buff};
 }
 
+std::string BoardToFen(const Board& board, const Player player) {
+  char buff[K_FEN_STR_SIZE];
+  const uint8_t size = BoardToFen_C(board.data(), player, buff);
+  return {buff, size};
+}
+
+bool BoardFromFen(const std::string_view fen, Board& board, Player& player) {
+  return BoardFromFen_C(fen.data(), fen.size(), board.data(), &player);
+}
+
 bool BoardEq(const Board& a, const Board& b) {
-  for (Position pos = 0; pos < K_BOARD_SIZE; pos++) {
-    if (a[pos] != b[pos]) {
-      return false;
-    }
-  }
-  return true;
+  return BoardEq_C(a.data(), b.data());
 }
 
 bool operator==(const Board& lhs, const Board& rhs) {
@@ -89,12 +93,79 @@ bool IsBeingCheckmate(const Board& board, Player player) {
   return IsBeingCheckmate_C(board.data(), player);
 }
 
+bool IsSquareAttacked(const Board& board, const Position pos,
+                      const Player by_player) {
+  return IsSquareAttacked_C(board.data(), pos, by_player);
+}
+
+AttackMap ComputeAttackMap(const Board& board, const Player player) {
+  AttackMap result;
+  ComputeAttackMap_C(board.data(), player, result.data());
+  return result;
+}
+
+GivesCheckInfo ComputeGivesCheckInfo(const Board& board, const Player player) {
+  GivesCheckInfo result;
+  ComputeGivesCheckInfo_C(board.data(), player, &result);
+  return result;
+}
+
+bool MoveGivesCheck(const Board& board, const GivesCheckInfo& info,
+                    const Movement movement) {
+  return MoveGivesCheck_C(board.data(), &info, movement);
+}
+
+bool MoveGivesCheck(const Board& board, const Movement movement) {
+  const Piece piece = board[Orig(movement)];
+  if (IsEmpty(piece)) {
+    return false;
+  }
+  return MoveGivesCheck(
+      board,
+      ComputeGivesCheckInfo(board, IsRed(piece) ? PLAYER_RED : PLAYER_BLACK),
+      movement);
+}
+
+int32_t StaticExchangeEval(const Board& board, const Movement movement) {
+  return StaticExchangeEval_C(board.data(), movement);
+}
+
 Winner GetWinner(const Board& board) { return GetWinner_C(board.data()); }
 
+bool HasAnyLegalMove(const Board& board, const Player player) {
+  return HasAnyLegalMove_C(board.data(), player);
+}
+
 bool DidPlayerLose(const Board& board, const Player player) {
   return DidPlayerLose_C(board.data(), player);
 }
 
+uint64_t ZobristKey(const Board& board, const Player player) {
+  return ZobristKey_C(board.data(), player);
+}
+
+uint64_t ZobristMoveKey(const uint64_t key, const Piece piece,
+                        const Piece captured, const Movement movement) {
+  return ZobristMoveKey_C(key, piece, captured, movement);
+}
+
+uint64_t ZobristMirrorKey(const Board& board, const Player player) {
+  return ZobristMirrorKey_C(board.data(), player);
+}
+
+uint64_t ZobristMirrorMoveKey(const uint64_t mirror_key, const Piece piece,
+                              const Piece captured, const Movement movement) {
+  return ZobristMirrorMoveKey_C(mirror_key, piece, captured, movement);
+}
+
+CanonicalKey SelectCanonicalKey(const uint64_t key, const uint64_t mirror_key) {
+  return SelectCanonicalKey_C(key, mirror_key);
+}
+
+CanonicalKey CanonicalZobristKey(const Board& board, const Player player) {
+  return CanonicalZobristKey_C(board.data(), player);
+}
+
 Board FlipBoard(const Board& board) {
   Board result;
   FlipBoard_C(result.data(), board.data());
@@ -126,6 +197,16 @@ Board DecodeBoardState(const BoardState& state) {
   return result;
 }
 
+void BoardStateMove(BoardState& state, const Piece piece, const Piece captured,
+                    const Movement movement) {
+  BoardStateMove_C(state.data(), piece, captured, movement);
+}
+
+void BoardStateUnmove(BoardState& state, const Piece piece,
+                      const Piece captured, const Movement movement) {
+  BoardStateUnmove_C(state.data(), piece, captured, movement);
+}
+
 MovesPerPiece PossiblePositions(const Board& board, const Position pos,
                                 const bool avoid_checkmate) {
   MovesPerPiece result;
@@ -137,6 +218,14 @@ Piece Move(Board& board, const Movement movement) {
   return Move_C(board.data(), movement);
 }
 
+Piece MakeMove(Board& board, const Movement movement, MoveUndo& undo) {
+  return MakeMove_C(board.data(), movement, &undo);
+}
+
+void UnmakeMove(Board& board, const MoveUndo& undo) {
+  UnmakeMove_C(board.data(), &undo);
+}
+
 // Returns a vector of all possible moves for player.
 std::vector<Movement> PossibleMoves(const Board& board, const Player player,
                                     const bool avoid_checkmate) {
@@ -146,21 +235,94 @@ std::vector<Movement> PossibleMoves(const Board& board, const Player player,
   return std::vector<Movement>{buff, buff + num_moves};
 }
 
+std::vector<Movement> PossibleCaptures(const Board& board, const Player player,
+                                       const bool avoid_checkmate) {
+  MaxMovesPerPlayerC buff;
+  const uint8_t num_moves =
+      PossibleCaptures_C(board.data(), player, avoid_checkmate, buff);
+  return std::vector<Movement>{buff, buff + num_moves};
+}
+
+std::vector<Movement> PossibleQuietMoves(const Board& board,
+                                         const Player player,
+                                         const bool avoid_checkmate) {
+  MaxMovesPerPlayerC buff;
+  const uint8_t num_moves =
+      PossibleQuietMoves_C(board.data(), player, avoid_checkmate, buff);
+  return std::vector<Movement>{buff, buff + num_moves};
+}
+
+std::vector<Movement> PossibleEvasions(const Board& board,
+                                       const Player player) {
+  MaxMovesPerPlayerC buff;
+  const uint8_t num_moves = PossibleEvasions_C(board.data(), player, buff);
+  return std::vector<Movement>{buff, buff + num_moves};
+}
+
+Movement ChildBoards::Iterator::movement() const {
+  return children_->children_.moves[children_->children_.next - 1];
+}
+
+ChildBoards::Iterator& ChildBoards::Iterator::operator++() {
+  children_->done_ =
+      !NextChildBoard_C(children_->board_.data(), &children_->children_);
+  return *this;
+}
+
+ChildBoards::ChildBoards(const Board& board, const Player player,
+                         const bool avoid_checkmate)
+    : board_(board) {
+  StartChildBoards_C(board_.data(), player, avoid_checkmate, &children_);
+}
+
+ChildBoards::Iterator ChildBoards::begin() {
+  Iterator res(this);
+  ++res;
+  return res;
+}
+
 std::vector<Board> PossibleBoards(const Board& board, const Player player,
                                   const bool avoid_checkmate) {
-  Piece buff[K_BOARD_SIZE * K_MAX_MOVE_PER_PLAYER];
-  const uint8_t moves =
-      PossibleBoards_C(board.data(), player, avoid_checkmate, buff);
+  ChildBoards children(board, player, avoid_checkmate);
   std::vector<Board> res;
-  res.reserve(moves);
-  for (size_t i = 0; i < moves; i++) {
-    Board cur;
-    CopyBoard_C(cur.data(), buff + i * K_BOARD_SIZE);
-    res.emplace_back(std::move(cur));
+  res.reserve(children.size());
+  for (const Board& child : children) {
+    res.push_back(child);
   }
   return res;
 }
 
+void BatchPossibleMoves(const std::vector<Board>& boards,
+                        const std::vector<Player>& players,
+                        const bool avoid_checkmate, MoveBatch& out) {
+  const uint32_t num_boards = static_cast<uint32_t>(boards.size());
+  if (num_boards == 0 || players.size() != boards.size()) {
+    out.moves.clear();
+    out.offsets.assign(1, 0);
+    return;
+  }
+  out.moves.resize(static_cast<size_t>(num_boards) * K_MAX_MOVE_PER_PLAYER);
+  out.offsets.resize(num_boards + 1);
+  // Board is a plain array of pieces, so a vector of boards is already laid
+  // out back to back.
+  const uint32_t num_moves = BatchPossibleMoves_C(
+      boards.front().data(), players.data(), num_boards, avoid_checkmate,
+      out.moves.data(), out.offsets.data());
+  out.moves.resize(num_moves);
+}
+
+void BatchPossibleBoards(const std::vector<Board>& boards,
+                         const MoveBatch& batch, std::vector<Board>& out) {
+  out.resize(batch.moves.size());
+  if (out.empty()) {
+    return;
+  }
+  BatchPossibleBoards_C(boards.front().data(),
+                        static_cast<uint32_t>(boards.size()),
+                        batch.moves.data(), batch.offsets.data(),
+                        out.front().data());
+}
+
 Position FindGeneral(const Board& board, const Player player) {
   return FindGeneral_C(board.data(), player);
 }
@@ -1,5 +1,6 @@
 #include "xiangqi/game.h"
 
+#include <algorithm>
 #include <cctype>
 #include <unordered_map>
 #include <utility>
@@ -10,26 +11,52 @@
 
 namespace xq {
 
-Game::Game() : board_{kStartingBoard} {}
+Game::Game()
+    : board_{kStartingBoard},
+      key_{ZobristKey(kStartingBoard, player_)},
+      mirror_key_{ZobristMirrorKey(kStartingBoard, player_)},
+      board_state_{EncodeBoardState(kStartingBoard)},
+      checkpoints_(1, kStartingBoard),
+      keys_{key_} {}
 
 void Game::Restart() {
   board_ = kStartingBoard;
+  key_ = ZobristKey(board_, player_);
+  mirror_key_ = ZobristMirrorKey(board_, player_);
+  board_state_ = EncodeBoardState(board_);
   initial_board_state_ = std::nullopt;
-  moves_.clear();
-  captured_.clear();
+  ResetRecord();
 }
 
 Player Game::CurrentPlayer() const { return player_; }
 
 const Board& Game::CurrentBoard() const { return board_; }
 
-size_t Game::MovesCount() const { return moves_.size(); }
+uint64_t Game::Key() const { return key_; }
+
+uint64_t Game::MirrorKey() const { return mirror_key_; }
+
+CanonicalKey Game::CanonicalZobristKey() const {
+  return SelectCanonicalKey(key_, mirror_key_);
+}
+
+const BoardState& Game::CurrentBoardState() const { return board_state_; }
+
+size_t Game::MovesCount() const { return ply_; }
+
+size_t Game::RecordedMovesCount() const { return moves_.size(); }
 
 void Game::MakeBlackMoveFirst() {
-  if (moves_.size() > 1) {
+  if (ply_ > 1) {
     return;
   }
+  TruncateRecord();
   player_ = PLAYER_BLACK;
+  first_player_ = ply_ == 0 ? player_ : ChangePlayer(player_);
+  key_ = ZobristKey(board_, player_);
+  mirror_key_ = ZobristMirrorKey(board_, player_);
+  keys_.front() = ZobristKey(checkpoints_.front(), first_player_);
+  keys_.back() = key_;
 }
 
 BoardState Game::InitialBoardState() const {
@@ -42,55 +69,160 @@ BoardState Game::InitialBoardState() const {
 Piece Game::PieceAt(Position pos) const { return board_[pos]; }
 
 Piece Game::Move(const Movement move) {
-  moves_.emplace_back(move);
   player_ = ChangePlayer(player_);
-  const Piece captured = xq::Move(board_, move);
-  captured_.emplace_back(captured);
+  const Piece piece =
+      move == K_NO_MOVEMENT ? PIECE_EMPTY : board_[Orig(move)];
+  MoveUndo undo;
+  const Piece captured = MakeMove(board_, move, undo);
+  key_ = ZobristMoveKey(key_, piece, captured, move);
+  mirror_key_ = ZobristMirrorMoveKey(mirror_key_, piece, captured, move);
+  BoardStateMove(board_state_, piece, captured, move);
+  if (ply_ < moves_.size() && moves_[ply_] == move) {
+    ply_++;
+    return captured;
+  }
+  TruncateRecord();
+  moves_.emplace_back(move);
+  undos_.emplace_back(undo);
+  PushKey(piece, captured, move);
+  ply_++;
+  if (ply_ % kCheckpointInterval == 0) {
+    checkpoints_.emplace_back(board_);
+  }
   return captured;
 }
 
-bool Game::CanUndo() const { return moves_.size() > 1; }
+bool Game::CanUndo() const { return ply_ > 1; }
 
 Movement Game::Undo() {
-  using enum Player;
-
   if (!CanUndo()) {
     return K_NO_MOVEMENT;
   }
-  Movement result = moves_.back();
-  const Piece captured = captured_.back();
-  moves_.pop_back();
-  captured_.pop_back();
-  player_ = ChangePlayer(player_);
+  SetPly(ply_ - 1);
+  const Movement result = moves_[ply_];
+  const MoveUndo& undo = undos_[ply_];
+
+  UnmakeMove(board_, undo);
+  // K_NO_MOVEMENT if the move did not change the board.
+  const Movement made = undo.movement;
+  const Piece piece = made == K_NO_MOVEMENT ? PIECE_EMPTY : board_[Orig(made)];
+  mirror_key_ = ZobristMirrorMoveKey(mirror_key_, piece, undo.captured, made);
+  BoardStateUnmove(board_state_, piece, undo.captured, made);
+  return result;
+}
 
-  xq::Move(board_, NewMovement(Dest(result), Orig(result)));
-  if (!IsEmpty(captured)) {
-    board_[Dest(result)] = captured;
+bool Game::SeekToPly(const size_t ply) {
+  if (ply > moves_.size()) {
+    return false;
   }
-  return result;
+  const size_t checkpoint = ply / kCheckpointInterval;
+  board_ = checkpoints_[checkpoint];
+  for (size_t i = checkpoint * kCheckpointInterval; i < ply; i++) {
+    xq::Move(board_, moves_[i]);
+  }
+  SetPly(ply);
+  mirror_key_ = ZobristMirrorKey(board_, player_);
+  board_state_ = EncodeBoardState(board_);
+  return true;
 }
 
-std::vector<Movement> Game::ExportMoves() const { return moves_; }
+std::vector<Movement> Game::ExportMoves() const {
+  return std::vector<Movement>(moves_.begin(), moves_.begin() + ply_);
+}
 
 // Restores game state from inital state.
 void Game::RestoreBoard(const BoardState& state) {
   initial_board_state_ = state;
   board_ = DecodeBoardState(state);
-  moves_.clear();
-  captured_.clear();
   player_ = PLAYER_RED;
+  key_ = ZobristKey(board_, player_);
+  mirror_key_ = ZobristMirrorKey(board_, player_);
+  board_state_ = EncodeBoardState(board_);
+  ResetRecord();
 }
 
 void Game::RestoreMoves(const std::vector<Movement>& moves) {
   if (moves.empty()) {
     return;
   }
-  player_ = IsRed(board_[Orig(moves.back())]) ? PLAYER_BLACK : PLAYER_RED;
-  moves_ = moves;
-  captured_.clear();
-  captured_.reserve(moves.size());
-  for (const Movement move : moves) {
-    captured_.emplace_back(xq::Move(board_, move));
+  const Board& initial_board = checkpoints_.front();
+  const Player first_player =
+      IsRed(initial_board[Orig(moves.front())]) ? PLAYER_RED : PLAYER_BLACK;
+  size_t shared = 0;
+  if (first_player == first_player_) {
+    const size_t max_shared = std::min(moves.size(), moves_.size());
+    while (shared < max_shared && moves[shared] == moves_[shared]) {
+      shared++;
+    }
+  }
+  SeekToPly(shared);
+  if (shared == 0) {
+    player_ = first_player;
+    key_ = ZobristKey(board_, player_);
+    mirror_key_ = ZobristMirrorKey(board_, player_);
+    ResetRecord();
+  }
+  TruncateRecord();
+  for (size_t i = shared; i < moves.size(); i++) {
+    Move(moves[i]);
+  }
+}
+
+size_t Game::RepetitionCount() const {
+  // Last irreversible ply up to the current one.
+  const auto last_irreversible = std::upper_bound(
+      irreversible_plies_.begin(), irreversible_plies_.end(), ply_);
+  const size_t start = last_irreversible == irreversible_plies_.begin()
+                           ? 0
+                           : *(last_irreversible - 1);
+  size_t res = 0;
+  // Positions with the same player to move are an even number of plies apart.
+  for (size_t ply = ply_; ply >= start + 2; ply -= 2) {
+    res += keys_[ply - 2] == key_;
+  }
+  return res;
+}
+
+bool Game::IsRepetition() const { return RepetitionCount() > 0; }
+
+void Game::ResetRecord() {
+  moves_.clear();
+  undos_.clear();
+  ply_ = 0;
+  first_player_ = player_;
+  checkpoints_.assign(1, board_);
+  keys_.assign(1, key_);
+  irreversible_plies_.clear();
+}
+
+void Game::SetPly(const size_t ply) {
+  ply_ = ply;
+  player_ = ply % 2 == 0 ? first_player_ : ChangePlayer(first_player_);
+  key_ = keys_[ply];
+}
+
+void Game::TruncateRecord() {
+  if (ply_ == moves_.size()) {
+    return;
+  }
+  moves_.resize(ply_);
+  undos_.resize(ply_);
+  checkpoints_.resize(ply_ / kCheckpointInterval + 1);
+  keys_.resize(ply_ + 1);
+  irreversible_plies_.erase(
+      std::upper_bound(irreversible_plies_.begin(), irreversible_plies_.end(),
+                       ply_),
+      irreversible_plies_.end());
+}
+
+void Game::PushKey(const Piece piece, const Piece captured,
+                   const Movement move) {
+  keys_.emplace_back(key_);
+  // Soldiers never move back, but may move sideways after crossing the river.
+  const bool soldier_advanced = (piece == R_SOLDIER || piece == B_SOLDIER) &&
+                                Row(Orig(move)) != Row(Dest(move));
+  if (!IsEmpty(captured) || soldier_advanced) {
+    irreversible_plies_.emplace_back(keys_.size() - 1);
   }
 }
 
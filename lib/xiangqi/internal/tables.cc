@@ -0,0 +1,276 @@
+#include "xiangqi/internal/tables_c.h"
+
+#include <bit>
+#include <cstdint>
+#include <initializer_list>
+
+#include "xiangqi/types_c.h"
+
+namespace {
+
+constexpr bool OnBoard(const int row, const int col) {
+  return row >= 0 && row < K_TOTAL_ROW && col >= 0 && col < K_TOTAL_COL;
+}
+
+constexpr bool InPalace(const int row, const int col, const bool is_red) {
+  return col >= 3 && col <= 5 &&
+         (is_red ? row >= 7 && row <= 9 : row >= 0 && row <= 2);
+}
+
+constexpr bool OnOwnSide(const int row, const bool is_red) {
+  return is_red ? row >= 5 : row <= 4;
+}
+
+constexpr bool IsAdvisorPosition(const int row, const int col,
+                                 const bool is_red) {
+  return InPalace(row, col, is_red) && (row + col) % 2 == (is_red ? 0 : 1);
+}
+
+constexpr bool IsElephantPosition(const int row, const int col,
+                                  const bool is_red) {
+  return OnBoard(row, col) && OnOwnSide(row, is_red) &&
+         row % 2 == (is_red ? 1 : 0) && col % 2 == 0 &&
+         (row / 2 + col / 2) % 2 == 1;
+}
+
+constexpr Position At(const int row, const int col) {
+  return static_cast<Position>(row * K_TOTAL_COL + col);
+}
+
+constexpr void AddStep(StepsC& steps, const int row, const int col) {
+  steps.dests[steps.count++] = At(row, col);
+}
+
+constexpr HorseLeapsC MakeHorseLeaps(const int row, const int col) {
+  // {row offset, col offset} of the destination, the leg is the orthogonal
+  // neighbor in the direction of the 2-step offset.
+  constexpr int kJumps[8][2] = {{-2, -1}, {-2, 1}, {2, -1}, {2, 1},
+                                {-1, -2}, {1, -2}, {-1, 2}, {1, 2}};
+  HorseLeapsC res{};
+  for (const auto& jump : kJumps) {
+    const int d_row = jump[0], d_col = jump[1];
+    if (!OnBoard(row + d_row, col + d_col)) {
+      continue;
+    }
+    const int leg_row = row + (d_row == 2 || d_row == -2 ? d_row / 2 : 0);
+    const int leg_col = col + (d_col == 2 || d_col == -2 ? d_col / 2 : 0);
+    res.leaps[res.count++] = {At(row + d_row, col + d_col),
+                              At(leg_row, leg_col)};
+  }
+  for (uint8_t i = res.count; i < 8; i++) {
+    res.leaps[i] = {K_NO_POSITION, K_NO_POSITION};
+  }
+  return res;
+}
+
+constexpr ElephantLeapsC MakeElephantLeaps(const int row, const int col,
+                                           const bool is_red) {
+  ElephantLeapsC res{};
+  for (uint8_t i = 0; i < 4; i++) {
+    res.leaps[i] = {K_NO_POSITION, K_NO_POSITION};
+  }
+  if (!IsElephantPosition(row, col, is_red)) {
+    return res;
+  }
+  for (const int d_row : {-1, 1}) {
+    for (const int d_col : {-1, 1}) {
+      if (IsElephantPosition(row + 2 * d_row, col + 2 * d_col, is_red)) {
+        res.leaps[res.count++] = {At(row + 2 * d_row, col + 2 * d_col),
+                                  At(row + d_row, col + d_col)};
+      }
+    }
+  }
+  return res;
+}
+
+constexpr StepsC EmptySteps() {
+  StepsC res{};
+  for (uint8_t i = 0; i < 4; i++) {
+    res.dests[i] = K_NO_POSITION;
+  }
+  return res;
+}
+
+constexpr StepsC MakeAdvisorSteps(const int row, const int col,
+                                  const bool is_red) {
+  StepsC res = EmptySteps();
+  if (!IsAdvisorPosition(row, col, is_red)) {
+    return res;
+  }
+  for (const int d_row : {-1, 1}) {
+    for (const int d_col : {-1, 1}) {
+      if (IsAdvisorPosition(row + d_row, col + d_col, is_red)) {
+        AddStep(res, row + d_row, col + d_col);
+      }
+    }
+  }
+  return res;
+}
+
+constexpr StepsC MakeGeneralSteps(const int row, const int col,
+                                  const bool is_red) {
+  StepsC res = EmptySteps();
+  if (!InPalace(row, col, is_red)) {
+    return res;
+  }
+  constexpr int kSteps[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+  for (const auto& step : kSteps) {
+    if (InPalace(row + step[0], col + step[1], is_red)) {
+      AddStep(res, row + step[0], col + step[1]);
+    }
+  }
+  return res;
+}
+
+constexpr StepsC MakeSoldierSteps(const int row, const int col,
+                                  const bool is_red) {
+  StepsC res = EmptySteps();
+  const int forward = is_red ? -1 : 1;
+  if (OnBoard(row + forward, col)) {
+    AddStep(res, row + forward, col);
+  }
+  if (!OnOwnSide(row, is_red)) {  // crossed river
+    if (col > 0) {
+      AddStep(res, row, col - 1);
+    }
+    if (col < K_TOTAL_COL - 1) {
+      AddStep(res, row, col + 1);
+    }
+  }
+  return res;
+}
+
+constexpr LeaperTablesC MakeLeaperTables() {
+  LeaperTablesC res{};
+  for (int row = 0; row < K_TOTAL_ROW; row++) {
+    for (int col = 0; col < K_TOTAL_COL; col++) {
+      const Position pos = At(row, col);
+      res.horse[pos] = MakeHorseLeaps(row, col);
+      for (const bool is_red : {false, true}) {
+        const int player = is_red ? PLAYER_RED : PLAYER_BLACK;
+        res.elephant[player][pos] = MakeElephantLeaps(row, col, is_red);
+        res.advisor[player][pos] = MakeAdvisorSteps(row, col, is_red);
+        res.general[player][pos] = MakeGeneralSteps(row, col, is_red);
+        res.soldier[player][pos] = MakeSoldierSteps(row, col, is_red);
+      }
+    }
+  }
+  return res;
+}
+
+// Targets of a slider at index idx of a line with the given length and
+// occupancy.
+constexpr SlideC MakeSlide(const int idx, const int length,
+                           const uint32_t occupancy) {
+  const uint32_t self = 1u << idx;
+  const uint32_t below = self - 1;
+  const uint32_t above = ((1u << length) - 1) & ~(below | self);
+  const uint32_t occ = occupancy & ~self;
+
+  // Towards higher indices, the first piece is the lowest set bit.
+  const uint32_t high_occ = occ & above;
+  const uint32_t high_first = high_occ & (~high_occ + 1);
+  const uint32_t high_rest = high_occ & ~high_first;
+  const uint32_t high_second = high_rest & (~high_rest + 1);
+  const uint32_t high_empty =
+      high_first == 0 ? above : (high_first - 1) & above;
+
+  // Towards lower indices, the first piece is the highest set bit.
+  const uint32_t low_occ = occ & below;
+  const uint32_t low_first = std::bit_floor(low_occ);
+  const uint32_t low_second = std::bit_floor(low_occ & ~low_first);
+  const uint32_t low_empty =
+      low_first == 0 ? below : below & ~((low_first << 1) - 1);
+
+  SlideC res{};
+  res.chariot = static_cast<uint16_t>(high_empty | high_first | low_empty |
+                                      low_first);
+  res.cannon = static_cast<uint16_t>(high_empty | high_second | low_empty |
+                                     low_second);
+  return res;
+}
+
+constexpr SliderTablesC MakeSliderTables() {
+  SliderTablesC res{};
+  for (int col = 0; col < K_TOTAL_COL; col++) {
+    for (uint32_t occ = 0; occ < (1u << K_TOTAL_COL); occ++) {
+      res.rank[col][occ] = MakeSlide(col, K_TOTAL_COL, occ);
+    }
+  }
+  for (int row = 0; row < K_TOTAL_ROW; row++) {
+    for (uint32_t occ = 0; occ < (1u << K_TOTAL_ROW); occ++) {
+      res.file[row][occ] = MakeSlide(row, K_TOTAL_ROW, occ);
+    }
+  }
+  return res;
+}
+
+constexpr SquareTablesC MakeSquareTables() {
+  SquareTablesC res{};
+  constexpr int kDirections[K_TOTAL_DIRECTIONS][2] = {
+      {-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+  for (int row = 0; row < K_TOTAL_ROW; row++) {
+    for (int col = 0; col < K_TOTAL_COL; col++) {
+      const Position pos = At(row, col);
+      for (int d = 0; d < K_TOTAL_DIRECTIONS; d++) {
+        int size = 0;
+        for (int r = row + kDirections[d][0], c = col + kDirections[d][1];
+             OnBoard(r, c); r += kDirections[d][0], c += kDirections[d][1]) {
+          res.rays[pos][d][size++] = At(r, c);
+        }
+        for (; size < K_MAX_RAY_SIZE; size++) {
+          res.rays[pos][d][size] = K_NO_POSITION;
+        }
+      }
+      int size = 0;
+      for (const int d_row : {-1, 1}) {
+        for (const int d_col : {-1, 1}) {
+          if (OnBoard(row + d_row, col + d_col)) {
+            res.diagonals[pos][size++] = At(row + d_row, col + d_col);
+          }
+        }
+      }
+      for (; size < 5; size++) {
+        res.diagonals[pos][size] = K_NO_POSITION;
+      }
+    }
+  }
+  return res;
+}
+
+// Pseudo random generator with a fixed seed, so that keys are the same across
+// builds and can be persisted.
+constexpr uint64_t SplitMix64(uint64_t& state) {
+  state += 0x9E3779B97F4A7C15ULL;
+  uint64_t z = state;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+constexpr ZobristTablesC MakeZobristTables() {
+  ZobristTablesC res{};
+  uint64_t state = 0x5869616E67716921ULL;
+  for (int piece = 0; piece < K_TOTAL_PIECE_VALUES; piece++) {
+    for (int pos = 0; pos < K_BOARD_SIZE; pos++) {
+      res.pieces[piece][pos] =
+          piece - R_SOLDIER == PIECE_EMPTY ? 0 : SplitMix64(state);
+    }
+  }
+  res.black_to_move = SplitMix64(state);
+  return res;
+}
+
+}  // namespace
+
+extern "C" {
+
+constinit const LeaperTablesC K_LEAPER_TABLES = MakeLeaperTables();
+
+constinit const SliderTablesC K_SLIDER_TABLES = MakeSliderTables();
+
+constinit const SquareTablesC K_SQUARE_TABLES = MakeSquareTables();
+
+constinit const ZobristTablesC K_ZOBRIST_TABLES = MakeZobristTables();
+
+}  // extern "C"
@@ -0,0 +1,87 @@
+#include "xiangqi/perft_c.h"
+
+#include "xiangqi/board_c.h"
+#include "xiangqi/tracked_board_c.h"
+#include "xiangqi/types_c.h"
+
+// --------------- Helper Function ---------------
+
+// Moves are made and taken back in place, board is restored on return.
+// Leaf nodes are counted without making the last move (bulk counting).
+static uint64_t PerftRecursive(BoardC board, const enum Player player,
+                               const uint8_t depth) {
+  MaxMovesPerPlayerC moves;
+  const uint8_t num_moves = PossibleMoves_C(board, player, true, moves);
+  if (depth == 1) {
+    return num_moves;
+  }
+  const enum Player opponent = ChangePlayer(player);
+  uint64_t res = 0;
+  for (uint8_t i = 0; i < num_moves; i++) {
+    MoveUndoC undo;
+    MakeMove_C(board, moves[i], &undo);
+    res += PerftRecursive(board, opponent, depth - 1);
+    UnmakeMove_C(board, &undo);
+  }
+  return res;
+}
+
+static uint64_t TrackedPerftRecursive(TrackedBoardC* tracked,
+                                      const enum Player player,
+                                      const uint8_t depth) {
+  MaxMovesPerPlayerC moves;
+  const uint8_t num_moves =
+      TrackedPossibleMoves_C(tracked, player, true, moves);
+  if (depth == 1) {
+    return num_moves;
+  }
+  const enum Player opponent = ChangePlayer(player);
+  uint64_t res = 0;
+  for (uint8_t i = 0; i < num_moves; i++) {
+    MoveUndoC undo;
+    TrackedMakeMove_C(tracked, moves[i], &undo);
+    res += TrackedPerftRecursive(tracked, opponent, depth - 1);
+    TrackedUnmakeMove_C(tracked, &undo);
+  }
+  return res;
+}
+
+// --------------- Public Function ---------------
+
+uint64_t Perft_C(const BoardC board, const enum Player player,
+                 const uint8_t depth) {
+  if (depth == 0) {
+    return 1;
+  }
+  BoardC copy;
+  CopyBoard_C(copy, board);
+  return PerftRecursive(copy, player, depth);
+}
+
+uint8_t PerftDivide_C(const BoardC board, const enum Player player,
+                      const uint8_t depth, MaxMovesPerPlayerC moves_out,
+                      uint64_t counts_out[K_MAX_MOVE_PER_PLAYER]) {
+  const uint8_t num_moves = PossibleMoves_C(board, player, true, moves_out);
+  BoardC copy;
+  CopyBoard_C(copy, board);
+  for (uint8_t i = 0; i < num_moves; i++) {
+    if (depth <= 1) {
+      counts_out[i] = 1;
+      continue;
+    }
+    MoveUndoC undo;
+    MakeMove_C(copy, moves_out[i], &undo);
+    counts_out[i] = PerftRecursive(copy, ChangePlayer(player), depth - 1);
+    UnmakeMove_C(copy, &undo);
+  }
+  return num_moves;
+}
+
+uint64_t TrackedPerft_C(const TrackedBoardC* tracked, const enum Player player,
+                        const uint8_t depth) {
+  if (depth == 0) {
+    return 1;
+  }
+  TrackedBoardC copy = *tracked;
+  return TrackedPerftRecursive(&copy, player, depth);
+}
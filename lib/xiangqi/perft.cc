@@ -0,0 +1,269 @@
+#include "xiangqi/perft.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "xiangqi/board.h"
+#include "xiangqi/board_c.h"
+#include "xiangqi/perft_c.h"
+#include "xiangqi/tracked_board.h"
+#include "xiangqi/types.h"
+
+namespace xq {
+
+namespace {
+
+// Subtrees are split further until there are this many per thread, so that
+// threads finishing early have something left to steal.
+constexpr size_t kTasksPerThread = 8;
+
+// Cache of subtree counts shared by all threads without locking. Each entry
+// stores the key XOR-ed with the data next to the data, an entry torn by
+// concurrent writes fails the check on probe and is treated as a miss.
+class PerftHashTable {
+ public:
+  explicit PerftHashTable(const size_t size_mb) {
+    size_t size = 1;
+    while (size * 2 * sizeof(Entry) <= size_mb * 1024 * 1024) {
+      size *= 2;
+    }
+    if (size_mb > 0) {
+      mask_ = size - 1;
+      entries_ = std::make_unique<Entry[]>(size);
+    }
+  }
+
+  std::optional<uint64_t> Probe(const uint64_t key, const uint8_t depth) const {
+    if (entries_ == nullptr) {
+      return std::nullopt;
+    }
+    const Entry& entry = entries_[key & mask_];
+    const uint64_t data = entry.data.load(std::memory_order_relaxed);
+    const uint64_t check = entry.check.load(std::memory_order_relaxed);
+    if ((check ^ data) != key || (data & 0xFF) != depth) {
+      return std::nullopt;
+    }
+    return data >> 8;
+  }
+
+  // Always replaces the existing entry.
+  void Store(const uint64_t key, const uint8_t depth, const uint64_t count) {
+    if (entries_ == nullptr) {
+      return;
+    }
+    Entry& entry = entries_[key & mask_];
+    const uint64_t data = count << 8 | depth;
+    entry.check.store(key ^ data, std::memory_order_relaxed);
+    entry.data.store(data, std::memory_order_relaxed);
+  }
+
+ private:
+  struct Entry {
+    std::atomic<uint64_t> check{0};
+    // Count in the upper 56 bits, depth in the lower 8 bits.
+    std::atomic<uint64_t> data{0};
+  };
+
+  size_t mask_ = 0;
+  std::unique_ptr<Entry[]> entries_;
+};
+
+// Same as Perft_C with depth of at least 1, looking up and storing the counts
+// of subtrees in hash. key is the Zobrist key of board and player.
+uint64_t HashedPerft(BoardC board, const Player player, const uint8_t depth,
+                     const uint64_t key, PerftHashTable& hash) {
+  // Depth 1 is never stored, cache hits skip generating the moves.
+  if (depth >= 2) {
+    if (const std::optional<uint64_t> cached = hash.Probe(key, depth)) {
+      return *cached;
+    }
+  }
+  MaxMovesPerPlayerC moves;
+  const uint8_t num_moves = PossibleMoves_C(board, player, true, moves);
+  if (depth == 1) {
+    return num_moves;
+  }
+  const Player opponent = ChangePlayer(player);
+  uint64_t res = 0;
+  for (uint8_t i = 0; i < num_moves; i++) {
+    const Piece piece = board[Orig(moves[i])];
+    MoveUndo undo;
+    const Piece captured = MakeMove_C(board, moves[i], &undo);
+    res += HashedPerft(board, opponent, depth - 1,
+                       ZobristMoveKey_C(key, piece, captured, moves[i]), hash);
+    UnmakeMove_C(board, &undo);
+  }
+  hash.Store(key, depth, res);
+  return res;
+}
+
+// A subtree to count, below root move root_index.
+struct PerftTask {
+  Board board;
+  Player player;
+  uint8_t depth;
+  uint64_t key;
+  size_t root_index;
+};
+
+// Task queues of the workers. A worker takes its own tasks from the back, and
+// steals from the front of the other queues once its own is empty.
+class WorkStealingQueues {
+ public:
+  explicit WorkStealingQueues(const size_t num_workers)
+      : queues_(num_workers) {}
+
+  // Not thread-safe, all tasks are pushed before the workers start.
+  void Push(const size_t worker, const size_t task) {
+    queues_[worker].tasks.push_back(task);
+  }
+
+  std::optional<size_t> Pop(const size_t worker) {
+    {
+      Queue& own = queues_[worker];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.tasks.empty()) {
+        const size_t task = own.tasks.back();
+        own.tasks.pop_back();
+        return task;
+      }
+    }
+    for (size_t i = 1; i < queues_.size(); i++) {
+      Queue& victim = queues_[(worker + i) % queues_.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.tasks.empty()) {
+        const size_t task = victim.tasks.front();
+        victim.tasks.pop_front();
+        return task;
+      }
+    }
+    return std::nullopt;
+  }
+
+ private:
+  struct alignas(64) Queue {
+    std::mutex mutex;
+    std::deque<size_t> tasks;
+  };
+
+  std::vector<Queue> queues_;
+};
+
+// Splits the subtree of task into the subtrees of its moves.
+void SplitTask(const PerftTask& task, std::vector<PerftTask>& out) {
+  for (const Movement movement : PossibleMoves(task.board, task.player, true)) {
+    PerftTask child = task;
+    const Piece piece = child.board[Orig(movement)];
+    const Piece captured = Move(child.board, movement);
+    child.player = ChangePlayer(task.player);
+    child.depth = task.depth - 1;
+    child.key = ZobristMoveKey_C(task.key, piece, captured, movement);
+    out.push_back(child);
+  }
+}
+
+}  // namespace
+
+uint64_t Perft(const Board& board, const Player player, const uint8_t depth) {
+  return Perft_C(board.data(), player, depth);
+}
+
+std::vector<std::pair<Movement, uint64_t>> PerftDivide(const Board& board,
+                                                       const Player player,
+                                                       const uint8_t depth) {
+  MaxMovesPerPlayerC moves;
+  uint64_t counts[K_MAX_MOVE_PER_PLAYER];
+  const uint8_t num_moves =
+      PerftDivide_C(board.data(), player, depth, moves, counts);
+  std::vector<std::pair<Movement, uint64_t>> result;
+  result.reserve(num_moves);
+  for (uint8_t i = 0; i < num_moves; i++) {
+    result.emplace_back(moves[i], counts[i]);
+  }
+  return result;
+}
+
+uint64_t TrackedPerft(const TrackedBoard& tracked, const Player player,
+                      const uint8_t depth) {
+  return TrackedPerft_C(&tracked, player, depth);
+}
+
+std::vector<std::pair<Movement, uint64_t>> ParallelPerftDivide(
+    const Board& board, const Player player, const uint8_t depth,
+    unsigned num_threads, const size_t hash_size_mb) {
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  std::vector<std::pair<Movement, uint64_t>> result;
+  for (const Movement movement : PossibleMoves(board, player, true)) {
+    result.emplace_back(movement, depth <= 1 ? 1 : 0);
+  }
+  if (depth <= 1) {
+    return result;
+  }
+
+  // Moves are generated in the same order as result.
+  const PerftTask root{board, player, depth, ZobristKey(board, player), 0};
+  std::vector<PerftTask> tasks;
+  SplitTask(root, tasks);
+  for (size_t i = 0; i < tasks.size(); i++) {
+    tasks[i].root_index = i;
+  }
+
+  // Split into the replies to the root moves if there are too few root moves.
+  if (tasks.size() < num_threads * kTasksPerThread && depth > 2) {
+    std::vector<PerftTask> split;
+    for (const PerftTask& task : tasks) {
+      SplitTask(task, split);
+    }
+    tasks = std::move(split);
+  }
+
+  WorkStealingQueues queues(num_threads);
+  for (size_t i = 0; i < tasks.size(); i++) {
+    queues.Push(i % num_threads, i);
+  }
+  PerftHashTable hash(hash_size_mb);
+  std::vector<uint64_t> counts(tasks.size(), 0);
+  std::vector<std::thread> workers;
+  for (unsigned worker = 0; worker < num_threads; worker++) {
+    workers.emplace_back([&, worker]() {
+      while (const std::optional<size_t> i = queues.Pop(worker)) {
+        PerftTask& task = tasks[*i];
+        counts[*i] = HashedPerft(task.board.data(), task.player, task.depth,
+                                 task.key, hash);
+      }
+    });
+  }
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  for (size_t i = 0; i < tasks.size(); i++) {
+    result[tasks[i].root_index].second += counts[i];
+  }
+  return result;
+}
+
+uint64_t ParallelPerft(const Board& board, const Player player,
+                       const uint8_t depth, const unsigned num_threads,
+                       const size_t hash_size_mb) {
+  if (depth == 0) {
+    return 1;
+  }
+  uint64_t res = 0;
+  for (const auto& [movement, count] :
+       ParallelPerftDivide(board, player, depth, num_threads, hash_size_mb)) {
+    res += count;
+  }
+  return res;
+}
+
+}  // namespace xq
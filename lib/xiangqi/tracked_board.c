@@ -0,0 +1,244 @@
+#include <string.h>
+
+#include "xiangqi/board_c.h"
+#include "xiangqi/internal/move_gen_c.h"
+#include "xiangqi/tracked_board_c.h"
+#include "xiangqi/types_c.h"
+
+// --------------- Helper Function ---------------
+
+static inline enum Player Owner(const enum Piece piece) {
+  return IsRed(piece) ? PLAYER_RED : PLAYER_BLACK;
+}
+
+static inline void AddPiece(TrackedBoardC* tracked, const enum Player player,
+                            const Position pos) {
+  const uint8_t idx = tracked->count[player]++;
+  tracked->pieces[player][idx] = pos;
+  tracked->index[pos] = idx;
+}
+
+// Removes the piece at pos from its owner's list by moving the last piece of
+// the list into its slot.
+static inline void RemovePiece(TrackedBoardC* tracked, const enum Player player,
+                               const Position pos) {
+  const uint8_t idx = tracked->index[pos];
+  const uint8_t last = --tracked->count[player];
+  const Position last_pos = tracked->pieces[player][last];
+  tracked->pieces[player][idx] = last_pos;
+  tracked->index[last_pos] = idx;
+  tracked->pieces[player][last] = K_NO_POSITION;
+  tracked->index[pos] = K_NO_PIECE_INDEX;
+}
+
+// Returns true if any of the opponent's pieces threatens player's general at
+// general_pos on board. The opponent's piece at skip, if any, was captured
+// and is ignored.
+static inline bool IsThreatened(const TrackedBoardC* tracked,
+                                const BoardC board, const enum Player player,
+                                const Position general_pos,
+                                const Position skip) {
+  if (general_pos == K_NO_POSITION) {
+    return true;
+  }
+  const enum Player opponent = ChangePlayer(player);
+  const Position* pieces = tracked->pieces[opponent];
+  GeneralSlidesC slides = NewGeneralSlides(general_pos);
+  for (uint8_t i = 0; i < tracked->count[opponent]; i++) {
+    if (pieces[i] != skip && ThreatensGeneral(board, pieces[i], &slides)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns true if making the move does not leave player's general threatened.
+// Capturing the opponent's general is always allowed. The move is made and
+// taken back in place on scratch, a copy of tracked's board, so the piece
+// lists never need to be touched.
+static inline bool IsLegalMove(const TrackedBoardC* tracked, BoardC scratch,
+                               const enum Player player,
+                               const Movement movement) {
+  MoveUndoC undo;
+  const enum Piece captured = MakeMove_C(scratch, movement, &undo);
+  if (captured == R_GENERAL || captured == B_GENERAL) {
+    UnmakeMove_C(scratch, &undo);
+    return true;
+  }
+  const Position from = Orig(movement);
+  const Position to = Dest(movement);
+  const Position general_pos =
+      tracked->general[player] == from ? to : tracked->general[player];
+  const bool res = !IsThreatened(tracked, scratch, player, general_pos,
+                                 IsEmpty(captured) ? K_NO_POSITION : to);
+  UnmakeMove_C(scratch, &undo);
+  return res;
+}
+
+static inline void ComputeTrackedCheckInfo(const TrackedBoardC* tracked,
+                                           const enum Player player,
+                                           CheckInfoC* out) {
+  const Position general_pos = tracked->general[player];
+  ComputeCheckInfo(tracked->board, general_pos,
+                   IsThreatened(tracked, tracked->board, player, general_pos,
+                                K_NO_POSITION),
+                   out);
+}
+
+// --------------- Public Function ---------------
+
+void TrackBoard_C(const BoardC board, TrackedBoardC* out) {
+  CopyBoard_C(out->board, board);
+  out->general[PLAYER_RED] = FindGeneral_C(board, PLAYER_RED);
+  out->general[PLAYER_BLACK] = FindGeneral_C(board, PLAYER_BLACK);
+  out->count[PLAYER_RED] = 0;
+  out->count[PLAYER_BLACK] = 0;
+  memset(out->pieces, K_NO_POSITION, sizeof(out->pieces));
+  memset(out->index, K_NO_PIECE_INDEX, sizeof(out->index));
+  for (Position pos = 0; pos < K_BOARD_SIZE; pos++) {
+    if (!IsEmpty(board[pos])) {
+      AddPiece(out, Owner(board[pos]), pos);
+    }
+  }
+}
+
+enum Piece TrackedMove_C(TrackedBoardC* tracked, const Movement movement) {
+  MoveUndoC undo;
+  return TrackedMakeMove_C(tracked, movement, &undo);
+}
+
+enum Piece TrackedMakeMove_C(TrackedBoardC* tracked, const Movement movement,
+                             MoveUndoC* undo) {
+  const Position to = Dest(movement);
+  const uint8_t captured_index =
+      movement == K_NO_MOVEMENT ? K_NO_PIECE_INDEX : tracked->index[to];
+  const enum Piece captured = MakeMove_C(tracked->board, movement, undo);
+  if (undo->movement == K_NO_MOVEMENT) {
+    return captured;
+  }
+  const enum Piece piece = tracked->board[to];
+  const enum Player player = Owner(piece);
+  if (!IsEmpty(captured)) {
+    const enum Player captured_player = Owner(captured);
+    RemovePiece(tracked, captured_player, to);
+    if (tracked->general[captured_player] == to) {
+      tracked->general[captured_player] = K_NO_POSITION;
+    }
+    undo->captured_index = captured_index;
+  }
+  const Position from = Orig(movement);
+  const uint8_t idx = tracked->index[from];
+  tracked->pieces[player][idx] = to;
+  tracked->index[to] = idx;
+  tracked->index[from] = K_NO_PIECE_INDEX;
+  if (piece == R_GENERAL || piece == B_GENERAL) {
+    tracked->general[player] = to;
+  }
+  return captured;
+}
+
+void TrackedUnmakeMove_C(TrackedBoardC* tracked, const MoveUndoC* undo) {
+  if (undo->movement == K_NO_MOVEMENT) {
+    return;
+  }
+  const Position from = Orig(undo->movement);
+  const Position to = Dest(undo->movement);
+  UnmakeMove_C(tracked->board, undo);
+
+  const enum Piece piece = tracked->board[from];
+  const enum Player player = Owner(piece);
+  const uint8_t idx = tracked->index[to];
+  tracked->pieces[player][idx] = from;
+  tracked->index[from] = idx;
+  tracked->index[to] = K_NO_PIECE_INDEX;
+  if (piece == R_GENERAL || piece == B_GENERAL) {
+    tracked->general[player] = from;
+  }
+
+  const enum Piece captured = undo->captured;
+  if (!IsEmpty(captured)) {
+    // Reverse of RemovePiece, move the piece that filled the captured piece's
+    // slot back to the end of the list.
+    const enum Player captured_player = Owner(captured);
+    Position* pieces = tracked->pieces[captured_player];
+    const uint8_t slot = undo->captured_index;
+    const uint8_t last = tracked->count[captured_player]++;
+    if (slot != last) {
+      pieces[last] = pieces[slot];
+      tracked->index[pieces[last]] = last;
+    }
+    pieces[slot] = to;
+    tracked->index[to] = slot;
+    if (captured == R_GENERAL || captured == B_GENERAL) {
+      tracked->general[captured_player] = to;
+    }
+  }
+}
+
+bool TrackedIsBeingCheckmate_C(const TrackedBoardC* tracked,
+                               const enum Player player) {
+  return IsThreatened(tracked, tracked->board, player, tracked->general[player],
+                      K_NO_POSITION);
+}
+
+uint8_t TrackedPossibleMoves_C(const TrackedBoardC* tracked,
+                               const enum Player player,
+                               const bool avoid_checkmate,
+                               MaxMovesPerPlayerC out) {
+  memset(out, 0xFFFF, K_MAX_MOVE_PER_PLAYER * sizeof(Movement));
+  const Position opponent_general = tracked->general[ChangePlayer(player)];
+  // Legality is checked by making moves in place on a single copy, and only
+  // for the moves flagged by info.
+  CheckInfoC info = {0};
+  BoardC scratch;
+  if (avoid_checkmate) {
+    ComputeTrackedCheckInfo(tracked, player, &info);
+    CopyBoard_C(scratch, tracked->board);
+  }
+  uint8_t res = 0;
+  MovesPerPieceC buff;
+  for (uint8_t i = 0; i < tracked->count[player]; i++) {
+    const Position pos = tracked->pieces[player][i];
+    const uint8_t num_moves =
+        PseudoPossiblePositions(tracked->board, pos, opponent_general, buff);
+    for (uint8_t j = 0; j < num_moves; j++) {
+      const Movement movement = NewMovement(pos, buff[j]);
+      if (!avoid_checkmate || !NeedsVerification(&info, pos, buff[j]) ||
+          IsLegalMove(tracked, scratch, player, movement)) {
+        *(out + res++) = movement;
+      }
+    }
+  }
+  return res;
+}
+
+bool TrackedDidPlayerLose_C(const TrackedBoardC* tracked,
+                            const enum Player player) {
+  // Same as comparing GetWinner_C with the opponent.
+  const enum Winner winner =
+      tracked->general[PLAYER_BLACK] == K_NO_POSITION ? WINNER_RED
+      : tracked->general[PLAYER_RED] == K_NO_POSITION ? WINNER_BLACK
+                                                      : WINNER_NONE;
+  if (winner == (player == PLAYER_RED ? WINNER_BLACK : WINNER_RED)) {
+    return true;
+  }
+
+  const Position opponent_general = tracked->general[ChangePlayer(player)];
+  CheckInfoC info = {0};
+  ComputeTrackedCheckInfo(tracked, player, &info);
+  BoardC scratch;
+  CopyBoard_C(scratch, tracked->board);
+  MovesPerPieceC buff;
+  for (uint8_t i = 0; i < tracked->count[player]; i++) {
+    const Position pos = tracked->pieces[player][i];
+    const uint8_t num_moves =
+        PseudoPossiblePositions(tracked->board, pos, opponent_general, buff);
+    for (uint8_t j = 0; j < num_moves; j++) {
+      if (!NeedsVerification(&info, pos, buff[j]) ||
+          IsLegalMove(tracked, scratch, player, NewMovement(pos, buff[j]))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
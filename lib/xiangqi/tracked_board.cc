@@ -0,0 +1,49 @@
+#include "xiangqi/tracked_board.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "xiangqi/board.h"
+#include "xiangqi/board_c.h"
+#include "xiangqi/tracked_board_c.h"
+#include "xiangqi/types.h"
+
+namespace xq {
+
+TrackedBoard TrackBoard(const Board& board) {
+  TrackedBoard result;
+  TrackBoard_C(board.data(), &result);
+  return result;
+}
+
+Piece TrackedMove(TrackedBoard& tracked, const Movement movement) {
+  return TrackedMove_C(&tracked, movement);
+}
+
+Piece TrackedMakeMove(TrackedBoard& tracked, const Movement movement,
+                      MoveUndo& undo) {
+  return TrackedMakeMove_C(&tracked, movement, &undo);
+}
+
+void TrackedUnmakeMove(TrackedBoard& tracked, const MoveUndo& undo) {
+  TrackedUnmakeMove_C(&tracked, &undo);
+}
+
+bool TrackedIsBeingCheckmate(const TrackedBoard& tracked, const Player player) {
+  return TrackedIsBeingCheckmate_C(&tracked, player);
+}
+
+std::vector<Movement> TrackedPossibleMoves(const TrackedBoard& tracked,
+                                           const Player player,
+                                           const bool avoid_checkmate) {
+  MaxMovesPerPlayerC buff;
+  const uint8_t num_moves =
+      TrackedPossibleMoves_C(&tracked, player, avoid_checkmate, buff);
+  return std::vector<Movement>{buff, buff + num_moves};
+}
+
+bool TrackedDidPlayerLose(const TrackedBoard& tracked, const Player player) {
+  return TrackedDidPlayerLose_C(&tracked, player);
+}
+
+}  // namespace xq
@@ -0,0 +1,178 @@
+#include "xiangqi/variation_tree.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "xiangqi/board.h"
+#include "xiangqi/types.h"
+
+namespace xq {
+
+VariationTree::VariationTree(const Board& board, const Player player)
+    : nodes_{Node{.key = ZobristKey(board, player),
+                  .parent = kNoNode,
+                  .first_child = kNoNode,
+                  .next_sibling = kNoNode,
+                  .depth = 0,
+                  .move = K_NO_MOVEMENT,
+                  .undo = {.movement = K_NO_MOVEMENT,
+                           .captured = PIECE_EMPTY,
+                           .captured_index = K_NO_PIECE_INDEX}}},
+      board_{board},
+      player_{player} {}
+
+VariationNode VariationTree::Current() const { return current_; }
+
+const Board& VariationTree::CurrentBoard() const { return board_; }
+
+Player VariationTree::CurrentPlayer() const { return player_; }
+
+uint64_t VariationTree::Key() const { return nodes_[current_].key; }
+
+VariationNode VariationTree::Move(const Movement move) {
+  const VariationNode existing = FindChild(current_, move);
+  if (existing != kNoNode) {
+    Replay(existing);
+    return existing;
+  }
+  const Node parent = nodes_[current_];
+  const Piece piece =
+      move == K_NO_MOVEMENT ? PIECE_EMPTY : board_[Orig(move)];
+  MoveUndo undo;
+  const Piece captured = MakeMove(board_, move, undo);
+  const VariationNode node = static_cast<VariationNode>(nodes_.size());
+  // New variations go last, the first child stays the main line.
+  VariationNode* link = &nodes_[current_].first_child;
+  while (*link != kNoNode) {
+    link = &nodes_[*link].next_sibling;
+  }
+  *link = node;
+  nodes_.emplace_back(Node{
+      .key = ZobristMoveKey(parent.key, piece, captured, move),
+      .parent = current_,
+      .first_child = kNoNode,
+      .next_sibling = kNoNode,
+      .depth = parent.depth + 1,
+      .move = move,
+      .undo = undo,
+  });
+  current_ = node;
+  player_ = ChangePlayer(player_);
+  return node;
+}
+
+bool VariationTree::Back() {
+  if (current_ == kRoot) {
+    return false;
+  }
+  TakeBack();
+  return true;
+}
+
+bool VariationTree::GoTo(const VariationNode node) {
+  if (node >= nodes_.size()) {
+    return false;
+  }
+  // Nodes between the common ancestor and node, deepest first.
+  std::vector<VariationNode> path;
+  VariationNode target = node;
+  while (nodes_[target].depth > nodes_[current_].depth) {
+    path.emplace_back(target);
+    target = nodes_[target].parent;
+  }
+  while (nodes_[current_].depth > nodes_[target].depth) {
+    TakeBack();
+  }
+  while (current_ != target) {
+    TakeBack();
+    path.emplace_back(target);
+    target = nodes_[target].parent;
+  }
+  for (auto it = path.rbegin(); it != path.rend(); it++) {
+    Replay(*it);
+  }
+  return true;
+}
+
+void VariationTree::PromoteVariation(const VariationNode node) {
+  if (node == kRoot || node >= nodes_.size()) {
+    return;
+  }
+  VariationNode* link = &nodes_[nodes_[node].parent].first_child;
+  while (*link != node) {
+    link = &nodes_[*link].next_sibling;
+  }
+  *link = nodes_[node].next_sibling;
+  nodes_[node].next_sibling = nodes_[nodes_[node].parent].first_child;
+  nodes_[nodes_[node].parent].first_child = node;
+}
+
+size_t VariationTree::NodesCount() const { return nodes_.size(); }
+
+VariationNode VariationTree::Parent(const VariationNode node) const {
+  return nodes_[node].parent;
+}
+
+VariationNode VariationTree::FirstChild(const VariationNode node) const {
+  return nodes_[node].first_child;
+}
+
+VariationNode VariationTree::NextSibling(const VariationNode node) const {
+  return nodes_[node].next_sibling;
+}
+
+VariationNode VariationTree::FindChild(const VariationNode node,
+                                       const Movement move) const {
+  for (VariationNode child = nodes_[node].first_child; child != kNoNode;
+       child = nodes_[child].next_sibling) {
+    if (nodes_[child].move == move) {
+      return child;
+    }
+  }
+  return kNoNode;
+}
+
+std::vector<VariationNode> VariationTree::Children(
+    const VariationNode node) const {
+  std::vector<VariationNode> result;
+  for (VariationNode child = nodes_[node].first_child; child != kNoNode;
+       child = nodes_[child].next_sibling) {
+    result.emplace_back(child);
+  }
+  return result;
+}
+
+Movement VariationTree::MoveOf(const VariationNode node) const {
+  return nodes_[node].move;
+}
+
+size_t VariationTree::Depth(const VariationNode node) const {
+  return nodes_[node].depth;
+}
+
+uint64_t VariationTree::KeyOf(const VariationNode node) const {
+  return nodes_[node].key;
+}
+
+std::vector<Movement> VariationTree::Line(VariationNode node) const {
+  std::vector<Movement> result(nodes_[node].depth);
+  for (; node != kRoot; node = nodes_[node].parent) {
+    result[nodes_[node].depth - 1] = nodes_[node].move;
+  }
+  return result;
+}
+
+void VariationTree::TakeBack() {
+  const Node& node = nodes_[current_];
+  UnmakeMove(board_, node.undo);
+  current_ = node.parent;
+  player_ = ChangePlayer(player_);
+}
+
+void VariationTree::Replay(const VariationNode node) {
+  xq::Move(board_, nodes_[node].move);
+  current_ = node;
+  player_ = ChangePlayer(player_);
+}
+
+}  // namespace xq
@@ -0,0 +1,111 @@
+// Counts leaf nodes of the legal move tree, split by root move.
+//
+// Usage: xiangqi_perft DEPTH [--black] [--threads N] [--hash MB] [BOARD_FILE]
+//
+// BOARD_FILE holds a board in the format of BoardFromString, the starting
+// board is used if omitted. Red moves first unless --black is given. With
+// --threads, counts in parallel with N threads (0 for one per hardware
+// thread) and a shared cache of --hash megabytes (64 by default).
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "xiangqi/board.h"
+#include "xiangqi/perft.h"
+#include "xiangqi/types.h"
+
+namespace {
+
+using ::xq::Board;
+using ::xq::BoardFromString;
+using ::xq::BoardToString;
+using ::xq::kStartingBoard;
+
+// Inverse of PosStr, e.g. "E9".
+std::string PositionToString(const Position pos) {
+  return {static_cast<char>('A' + Col(pos)), static_cast<char>('0' + Row(pos))};
+}
+
+std::string MovementToString(const Movement movement) {
+  return PositionToString(Orig(movement)) + PositionToString(Dest(movement));
+}
+
+int PrintUsage(const char* program) {
+  std::cerr << "Usage: " << program
+            << " DEPTH [--black] [--threads N] [--hash MB] [BOARD_FILE]\n";
+  return EXIT_FAILURE;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    return PrintUsage(argv[0]);
+  }
+  const int depth = std::atoi(argv[1]);
+  if (depth < 1 || depth > 255) {
+    return PrintUsage(argv[0]);
+  }
+  Player player = PLAYER_RED;
+  Board board = kStartingBoard;
+  std::optional<unsigned> num_threads;
+  size_t hash_size_mb = 64;
+  for (int i = 2; i < argc; i++) {
+    const std::string_view arg = argv[i];
+    if (arg == "--black") {
+      player = PLAYER_BLACK;
+      continue;
+    }
+    if ((arg == "--threads" || arg == "--hash") && i + 1 < argc) {
+      const int value = std::atoi(argv[++i]);
+      if (value < 0) {
+        return PrintUsage(argv[0]);
+      }
+      if (arg == "--threads") {
+        num_threads = static_cast<unsigned>(value);
+      } else {
+        hash_size_mb = static_cast<size_t>(value);
+      }
+      continue;
+    }
+    std::ifstream file{argv[i]};
+    if (!file) {
+      std::cerr << "Cannot read " << arg << "\n";
+      return PrintUsage(argv[0]);
+    }
+    std::stringstream str;
+    str << file.rdbuf();
+    board = BoardFromString(str.str());
+  }
+
+  std::cout << BoardToString(board) << "\n";
+  const auto start = std::chrono::steady_clock::now();
+  const auto division =
+      num_threads.has_value()
+          ? xq::ParallelPerftDivide(board, player, static_cast<uint8_t>(depth),
+                                    *num_threads, hash_size_mb)
+          : xq::PerftDivide(board, player, static_cast<uint8_t>(depth));
+  const std::chrono::duration<double> duration =
+      std::chrono::steady_clock::now() - start;
+
+  uint64_t nodes = 0;
+  for (const auto& [movement, count] : division) {
+    std::cout << MovementToString(movement) << ": " << count << "\n";
+    nodes += count;
+  }
+  std::cout << "\nMoves: " << division.size() << "\n"
+            << "Nodes: " << nodes << "\n"
+            << "Time: " << duration.count() << "s\n"
+            << "Nodes/s: "
+            << static_cast<uint64_t>(static_cast<double>(nodes) /
+                                     duration.count())
+            << "\n";
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,72 @@
+// file: test_bitboard.cc
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "xiangqi/bitboard.h"
+#include "xiangqi/board.h"
+#include "xiangqi/types.h"
+#include "test_util.h"
+
+namespace {
+
+namespace {
+
+using namespace ::xq;
+using namespace ::xq::test;
+
+}  // namespace
+
+TEST(Bitboard, RoundTrip) {
+  const Bitboards bitboards = BoardToBitboards(kStartingBoard);
+  EXPECT_EQ(BitboardCount(bitboards.occupancy), K_TOTAL_PIECES);
+  EXPECT_EQ(BitboardCount(bitboards.colors[PLAYER_RED]), 16);
+  EXPECT_EQ(BitboardCount(bitboards.types[R_SOLDIER]), 10);
+  EXPECT_TRUE(BitboardHas(PlayerPieces(&bitboards, B_GENERAL), PosStr("E0")));
+  EXPECT_TRUE(BitboardHas(PlayerPieces(&bitboards, R_GENERAL), PosStr("E9")));
+  EXPECT_EQ(BitboardsToBoard(bitboards), kStartingBoard);
+
+  const Board board = BoardFromString(
+      "  A B C D E F G H I \n"
+      "0 . . . a * g . . . \n"
+      "1 . . . * H * . . . \n"
+      "2 . . . * * * . . . \n"
+      "3 . . . . . . . . . \n"
+      "4 - - - - - - - - - \n"
+      "5 - - - - - - - - - \n"
+      "6 . . . . . . . . . \n"
+      "7 . . . * * * . . . \n"
+      "8 . . . * * * . . . \n"
+      "9 . . . * G * . . R \n");
+  const Bitboards bitboards_2 = BoardToBitboards(board);
+  EXPECT_EQ(BitboardFirst(bitboards_2.occupancy), PosStr("D0"));
+  EXPECT_TRUE(BitboardHas(bitboards_2.types[R_CHARIOT], PosStr("I9")));
+  EXPECT_EQ(BitboardsToBoard(bitboards_2), board);
+}
+
+TEST(Bitboard, PossibleMovesStartingBoard) {
+  const Bitboards bitboards = BoardToBitboards(kStartingBoard);
+  EXPECT_EQ(Sorted(BitboardPossibleMoves(bitboards, PLAYER_RED)),
+            Sorted(PossibleMoves(kStartingBoard, PLAYER_RED)));
+  EXPECT_EQ(Sorted(BitboardPossibleMoves(bitboards, PLAYER_BLACK)),
+            Sorted(PossibleMoves(kStartingBoard, PLAYER_BLACK)));
+}
+
+TEST(Bitboard, PossibleMovesMatchMailbox) {
+  std::mt19937 rng(20250214);
+  for (int game = 0; game < 20; game++) {
+    RandomPlayout(
+        rng, {.max_plies = 150},
+        [](const Board& board, const Player player,
+           const std::vector<Movement>& expected) {
+          ASSERT_EQ(
+              Sorted(BitboardPossibleMoves(BoardToBitboards(board), player)),
+              Sorted(expected))
+              << BoardToString(board);
+        });
+  }
+}
+
+}  // namespace
@@ -1,16 +1,21 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <random>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "xiangqi/board.h"
 #include "xiangqi/types.h"
+#include "test_util.h"
 
 namespace {
 
 namespace {
 
 using namespace ::xq;
+using namespace ::xq::test;
 
 constexpr std::string_view kStartingBoardStr =
     "  A B C D E F G H I \n"
@@ -25,6 +30,9 @@ constexpr std::string_view kStartingBoardStr =
     "8 . . . * * * . . . \n"
     "9 R H E A G A E H R \n";
 
+constexpr std::string_view kStartingFen =
+    "rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR w - - 0 1";
+
 }  // namespace
 
 TEST(Board, PosStr) {
@@ -61,6 +69,94 @@ TEST(Board, ToString) {
                                     << kStartingBoardStr;
 }
 
+TEST(Board, ToFen) {
+  EXPECT_EQ(BoardToFen(kStartingBoard, PLAYER_RED), kStartingFen);
+  const Board board = BoardFromString(
+      "  A B C D E F G H I \n"
+      "0 . . . g * a . . . \n"
+      "1 . . . * a * . . . \n"
+      "2 . . . * * * . . . \n"
+      "3 s . . . . . h . s \n"
+      "4 - - - - - - - - - \n"
+      "5 - - - - - - - - - \n"
+      "6 S . . . . . . . S \n"
+      "7 . . . * * * . H . \n"
+      "8 . . . * A * . . . \n"
+      "9 . . . A * G . . . \n");
+  EXPECT_EQ(BoardToFen(board, PLAYER_BLACK),
+            "3k1a3/4a4/9/p5n1p/9/9/P7P/7N1/4A4/3A1K3 b - - 0 1");
+
+  Board empty;
+  empty.fill(PIECE_EMPTY);
+  char buff[K_FEN_STR_SIZE];
+  EXPECT_EQ(BoardToFen_C(empty.data(), PLAYER_RED, buff), 29);
+  EXPECT_STREQ(buff, "9/9/9/9/9/9/9/9/9/9 w - - 0 1");
+}
+
+TEST(Board, FromFen) {
+  Board board;
+  Player player = PLAYER_BLACK;
+  ASSERT_TRUE(BoardFromFen(kStartingFen, board, player));
+  EXPECT_EQ(board, kStartingBoard);
+  EXPECT_EQ(player, PLAYER_RED);
+
+  // Only the piece placement is required, H and E are accepted.
+  ASSERT_TRUE(BoardFromFen(
+      "rheakaehr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RHEAKAEHR b",
+      board, player));
+  EXPECT_EQ(board, kStartingBoard);
+  EXPECT_EQ(player, PLAYER_BLACK);
+  ASSERT_TRUE(BoardFromFen(kStartingFen.substr(0, kStartingFen.find(' ')),
+                           board, player));
+  EXPECT_EQ(board, kStartingBoard);
+  EXPECT_EQ(player, PLAYER_RED);
+
+  // Only the given characters are read.
+  ASSERT_TRUE(BoardFromFen(
+      std::string_view("9/9/9/9/9/9/9/9/9/4K4 r garbage").substr(0, 21),
+      board, player));
+  EXPECT_EQ(player, PLAYER_RED);
+  EXPECT_EQ(board[PosStr("E9")], R_GENERAL);
+  EXPECT_EQ(std::count(board.begin(), board.end(), PIECE_EMPTY), 89);
+
+  for (const std::string_view fen : {
+           "",
+           "rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9",
+           "rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR/9",
+           "rnbakabnr/8/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR",
+           "rnbakabnrr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR",
+           "rnbakabn5/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR",
+           "rnbakabnx/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR",
+           "rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR x",
+           "rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR wb",
+           "rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNRw",
+       }) {
+    EXPECT_FALSE(BoardFromFen(fen, board, player)) << fen;
+  }
+}
+
+TEST(Board, FenRoundTrip) {
+  std::mt19937 rng(20250330);
+  std::uniform_int_distribution<int> dist(B_SOLDIER, R_SOLDIER);
+  for (int i = 0; i < 100; i++) {
+    Board board;
+    for (Piece& piece : board) {
+      piece = static_cast<Piece>(dist(rng));
+      // Every other board has runs of empty positions.
+      if (i % 2 == 1 && rng() % 2 == 0) {
+        piece = PIECE_EMPTY;
+      }
+    }
+    const Player player = i % 3 == 0 ? PLAYER_BLACK : PLAYER_RED;
+    const std::string fen = BoardToFen(board, player);
+    Board parsed;
+    Player parsed_player;
+    ASSERT_TRUE(BoardFromFen(fen, parsed, parsed_player)) << fen;
+    EXPECT_EQ(parsed, board) << fen;
+    EXPECT_EQ(parsed_player, player);
+  }
+}
+
 // ---------------------------------------------------------------------
 // Test FlipPosition and FlipBoard
 // ---------------------------------------------------------------------
@@ -195,6 +291,50 @@ TEST(Board, MirrorBoardVertical) {
   EXPECT_EQ(mirrored_1, expected_1);
 }
 
+// Transforms are vectorized over pairs of rows, check every position on
+// boards with arbitrary pieces everywhere.
+TEST(Board, TransformRandomBoards) {
+  std::mt19937 rng(20250309);
+  std::uniform_int_distribution<int> dist(B_SOLDIER, R_SOLDIER);
+  for (int i = 0; i < 100; i++) {
+    Board board;
+    for (Piece& piece : board) {
+      piece = static_cast<Piece>(dist(rng));
+    }
+    const Board flipped = FlipBoard(board);
+    const Board mirrored_horizontal = MirrorBoardHorizontal(board);
+    const Board mirrored_vertical = MirrorBoardVertical(board);
+    for (Position pos = 0; pos < K_BOARD_SIZE; pos++) {
+      ASSERT_EQ(flipped[FlipPosition(pos)], -board[pos]);
+      ASSERT_EQ(mirrored_horizontal[MirrorPositionHorizontal(pos)],
+                board[pos]);
+      ASSERT_EQ(mirrored_vertical[MirrorPositionVertical(pos)], -board[pos]);
+    }
+    EXPECT_EQ(FlipBoard(flipped), board);
+    EXPECT_EQ(MirrorBoardHorizontal(mirrored_horizontal), board);
+    EXPECT_EQ(MirrorBoardVertical(mirrored_vertical), board);
+
+    // Destination may be the source.
+    Board in_place = board;
+    FlipBoard_C(in_place.data(), in_place.data());
+    EXPECT_EQ(in_place, flipped);
+    in_place = board;
+    MirrorBoardHorizontal_C(in_place.data(), in_place.data());
+    EXPECT_EQ(in_place, mirrored_horizontal);
+    in_place = board;
+    MirrorBoardVertical_C(in_place.data(), in_place.data());
+    EXPECT_EQ(in_place, mirrored_vertical);
+  }
+}
+
+TEST(Board, BoardNotEqualAnyPosition) {
+  for (Position pos = 0; pos < K_BOARD_SIZE; pos++) {
+    Board board = kStartingBoard;
+    board[pos] = board[pos] == R_SOLDIER ? B_SOLDIER : R_SOLDIER;
+    EXPECT_NE(board, kStartingBoard) << static_cast<int>(pos);
+  }
+}
+
 // ---------------------------------------------------------------------
 // Test Move
 // ---------------------------------------------------------------------
@@ -283,6 +423,97 @@ TEST(Board, CanDoInvalidMove) {
   EXPECT_EQ(capture, PIECE_EMPTY);
 }
 
+TEST(Board, MakeUnmakeMove) {
+  Board board = kStartingBoard;
+  MoveUndo undo_1, undo_2, undo_3, undo_4;
+
+  EXPECT_EQ(MakeMove(board, NewMovement(PosStr("B7"), PosStr("B0")), undo_1),
+            B_HORSE);
+  const Board after_1 = board;
+  EXPECT_EQ(MakeMove(board, NewMovement(PosStr("E0"), PosStr("E1")), undo_2),
+            PIECE_EMPTY);
+  const Board after_2 = board;
+  // Invalid moves do not change the board, and taking them back is a no-op.
+  EXPECT_EQ(MakeMove(board, NewMovement(PosStr("H0"), PosStr("H0")), undo_3),
+            PIECE_EMPTY);
+  EXPECT_EQ(MakeMove(board, NewMovement(PosStr("E5"), PosStr("E4")), undo_4),
+            PIECE_EMPTY);
+  EXPECT_EQ(board, after_2);
+
+  UnmakeMove(board, undo_4);
+  UnmakeMove(board, undo_3);
+  EXPECT_EQ(board, after_2);
+  UnmakeMove(board, undo_2);
+  EXPECT_EQ(board, after_1);
+  UnmakeMove(board, undo_1);
+  EXPECT_EQ(board, kStartingBoard);
+}
+
+TEST(Board, ZobristMoveKey) {
+  Board board = kStartingBoard;
+  const uint64_t initial_key = ZobristKey(board, PLAYER_RED);
+  uint64_t key = initial_key;
+
+  const Movement move_1 = NewMovement(PosStr("B7"), PosStr("B0"));
+  const Piece captured_1 = Move(board, move_1);
+  key = ZobristMoveKey(key, R_CANNON, captured_1, move_1);
+  EXPECT_EQ(key, ZobristKey(board, PLAYER_BLACK));
+
+  const Movement move_2 = NewMovement(PosStr("A0"), PosStr("A1"));
+  const Piece captured_2 = Move(board, move_2);
+  key = ZobristMoveKey(key, B_CHARIOT, captured_2, move_2);
+  EXPECT_EQ(key, ZobristKey(board, PLAYER_RED));
+
+  // Moves that do not change the board only switch the player.
+  key = ZobristMoveKey(key, PIECE_EMPTY, PIECE_EMPTY, K_NO_MOVEMENT);
+  EXPECT_EQ(key, ZobristKey(board, PLAYER_BLACK));
+  key = ZobristMoveKey(key, PIECE_EMPTY, PIECE_EMPTY, K_NO_MOVEMENT);
+
+  // Applying the same updates again takes the moves back.
+  key = ZobristMoveKey(key, B_CHARIOT, captured_2, move_2);
+  key = ZobristMoveKey(key, R_CANNON, captured_1, move_1);
+  EXPECT_EQ(key, initial_key);
+}
+
+TEST(Board, CanonicalZobristKey) {
+  std::mt19937 rng(20250324);
+  RandomPlayout(
+      rng, {.max_plies = 100},
+      [](const Board& board, const Player player,
+         const std::vector<Movement>&) {
+        const Board mirror = MirrorBoardHorizontal(board);
+        const uint64_t key = ZobristKey(board, player);
+        const uint64_t mirror_key = ZobristKey(mirror, player);
+        ASSERT_EQ(ZobristMirrorKey(board, player), mirror_key);
+
+        const CanonicalKey canonical = CanonicalZobristKey(board, player);
+        const CanonicalKey mirror_canonical =
+            CanonicalZobristKey(mirror, player);
+        ASSERT_EQ(canonical.key, mirror_canonical.key);
+        ASSERT_EQ(canonical.key, std::min(key, mirror_key));
+        if (key != mirror_key) {
+          ASSERT_NE(canonical.mirrored, mirror_canonical.mirrored);
+          ASSERT_EQ(canonical.mirrored, canonical.key == mirror_key);
+        }
+      },
+      [](const Board& board, const Player player, const Movement move) {
+        const uint64_t mirror_key = ZobristMirrorKey(board, player);
+        Board after = board;
+        const Piece piece = board[Orig(move)];
+        const Piece captured = Move(after, move);
+        ASSERT_EQ(ZobristMirrorMoveKey(mirror_key, piece, captured, move),
+                  ZobristMirrorKey(after, ChangePlayer(player)));
+        // The mirrored move on the mirrored board leads to the same position.
+        Board moved_mirror = MirrorBoardHorizontal(board);
+        Move(moved_mirror, MirrorMovementHorizontal(move));
+        ASSERT_EQ(moved_mirror, MirrorBoardHorizontal(after));
+      });
+  const CanonicalKey symmetric =
+      CanonicalZobristKey(kStartingBoard, PLAYER_RED);
+  EXPECT_EQ(symmetric.key, ZobristKey(kStartingBoard, PLAYER_RED));
+  EXPECT_FALSE(symmetric.mirrored);
+}
+
 // ---------------------------------------------------------------------
 // Test FindGeneral
 // ---------------------------------------------------------------------
@@ -845,6 +1076,21 @@ TEST(Board, IsBeingCheckmateChariot) {
       "9 . . . * r * . . . \n");
   EXPECT_TRUE(IsBeingCheckmate(board_13, PLAYER_RED));
   EXPECT_TRUE(IsBeingCheckmate(board_13, PLAYER_BLACK));
+
+  // Chariot at the end of a row does not wrap around to the next row.
+  const Board board_14 = BoardFromString(
+      "  A B C D E F G H I \n"
+      "0 . . . * * * . . R \n"
+      "1 . . . g * * . . . \n"
+      "2 . . . * * * . . . \n"
+      "3 . . . . . . . . . \n"
+      "4 - - - - - - - - - \n"
+      "5 - - - - - - - - - \n"
+      "6 . . . . . . . . . \n"
+      "7 . . . * * * . . . \n"
+      "8 . . . * * * . . . \n"
+      "9 . . . * G * . . . \n");
+  EXPECT_FALSE(IsBeingCheckmate(board_14, PLAYER_BLACK));
 }
 
 TEST(Board, IsBeingCheckmateHorse) {
@@ -1321,6 +1567,216 @@ TEST(Board, IsBeingCheckmateSoldier) {
 // Test GetWinner
 // ---------------------------------------------------------------------
 
+TEST(Board, IsSquareAttacked) {
+  // Black soldier B4 is the screen of black cannon B2 and the leg of red horse
+  // B5.
+  Board board = BoardFromString(
+      "  A B C D E F G H I \n"
+      "0 . . . . g . . . . \n"
+      "1 . . . * * * . . . \n"
+      "2 . c . * * * . . . \n"
+      "3 . . . . . . . . . \n"
+      "4 - s - - - - - - - \n"
+      "5 - H - - - - - - - \n"
+      "6 . . . . . . . . . \n"
+      "7 . . . * * * . . . \n"
+      "8 . . . * A * . . . \n"
+      "9 . . E . G . E . . \n");
+  EXPECT_TRUE(IsSquareAttacked(board, PosStr("B5"), PLAYER_BLACK));
+  EXPECT_FALSE(IsSquareAttacked(board, PosStr("B6"), PLAYER_BLACK));
+  EXPECT_FALSE(IsSquareAttacked(board, PosStr("B3"), PLAYER_BLACK));
+  EXPECT_TRUE(IsSquareAttacked(board, PosStr("E1"), PLAYER_BLACK));
+  EXPECT_FALSE(IsSquareAttacked(board, PosStr("C3"), PLAYER_RED));
+  EXPECT_TRUE(IsSquareAttacked(board, PosStr("D4"), PLAYER_RED));
+  EXPECT_TRUE(IsSquareAttacked(board, PosStr("A7"), PLAYER_RED));
+  EXPECT_TRUE(IsSquareAttacked(board, PosStr("E7"), PLAYER_RED));
+  EXPECT_FALSE(IsSquareAttacked(board, PosStr("E0"), PLAYER_RED));
+
+  const AttackMap red = ComputeAttackMap(board, PLAYER_RED);
+  EXPECT_EQ(red[PosStr("E8")], 1);
+  EXPECT_EQ(red[PosStr("D9")], 2);
+  EXPECT_EQ(red[PosStr("E7")], 2);
+  EXPECT_EQ(red[PosStr("A7")], 2);
+  EXPECT_EQ(red[PosStr("D8")], 0);
+  EXPECT_EQ(red[PosStr("A3")], 0);
+
+  // Flying general only attacks the opponent's general.
+  board[PosStr("E8")] = PIECE_EMPTY;
+  EXPECT_TRUE(IsSquareAttacked(board, PosStr("E0"), PLAYER_RED));
+  EXPECT_FALSE(IsSquareAttacked(board, PosStr("E3"), PLAYER_RED));
+  EXPECT_EQ(ComputeAttackMap(board, PLAYER_RED)[PosStr("E0")], 1);
+  EXPECT_EQ(ComputeAttackMap(board, PLAYER_BLACK)[PosStr("E9")], 1);
+}
+
+TEST(Board, AttackMapMatchesPossibleMoves) {
+  std::mt19937 rng(20250313);
+  for (int game = 0; game < 20; game++) {
+    RandomPlayout(rng, {.max_plies = 150}, [](const Board& board, Player,
+                                              const std::vector<Movement>&) {
+      for (const Player attacker : {PLAYER_RED, PLAYER_BLACK}) {
+        const AttackMap attacks = ComputeAttackMap(board, attacker);
+        const Piece target = attacker == PLAYER_RED ? B_SOLDIER : R_SOLDIER;
+        const Piece opponent_general =
+            attacker == PLAYER_RED ? B_GENERAL : R_GENERAL;
+        for (Position pos = 0; pos < K_BOARD_SIZE; pos++) {
+          // Pseudo-legal captures of an opponent's piece placed on pos.
+          Board with_target = board;
+          if (with_target[pos] != opponent_general) {
+            with_target[pos] = target;
+          }
+          int captures = 0;
+          for (const Movement move :
+               PossibleMoves(with_target, attacker, false)) {
+            captures += Dest(move) == pos;
+          }
+          ASSERT_EQ(attacks[pos], captures)
+              << BoardToString(board) << static_cast<int>(pos);
+          ASSERT_EQ(IsSquareAttacked(board, pos, attacker), captures > 0)
+              << BoardToString(board) << static_cast<int>(pos);
+        }
+      }
+    });
+  }
+}
+
+TEST(Board, MoveGivesCheck) {
+  // Black is not in check: chariot A0 is blocked by horse C0, cannon I0 has no
+  // screen, cannon E7 has two, and the leg of horse D2 is blocked.
+  const Board board = BoardFromString(
+      "  A B C D E F G H I \n"
+      "0 R . H * g * . . C \n"
+      "1 . . . S * * . . . \n"
+      "2 . . . H * * . H . \n"
+      "3 . . . . s . . . . \n"
+      "4 - - - - - - - - - \n"
+      "5 - - - - H - - - - \n"
+      "6 . . . . . . . . . \n"
+      "7 . . . * C * . . . \n"
+      "8 . . . * * * . . . \n"
+      "9 . . . * G * . . . \n");
+  ASSERT_FALSE(IsBeingCheckmate(board, PLAYER_BLACK));
+  // Discovered chariot.
+  EXPECT_TRUE(MoveGivesCheck(board, NewMovement(PosStr("C0"), PosStr("B2"))));
+  // Cannon screen appears.
+  EXPECT_TRUE(MoveGivesCheck(board, NewMovement(PosStr("H2"), PosStr("G0"))));
+  // Cannon screen disappears.
+  EXPECT_TRUE(MoveGivesCheck(board, NewMovement(PosStr("E5"), PosStr("D3"))));
+  // Horse leg unblocked.
+  EXPECT_TRUE(MoveGivesCheck(board, NewMovement(PosStr("D1"), PosStr("C1"))));
+
+  EXPECT_FALSE(MoveGivesCheck(board, NewMovement(PosStr("A0"), PosStr("A1"))));
+  EXPECT_FALSE(MoveGivesCheck(board, NewMovement(PosStr("H2"), PosStr("G4"))));
+  EXPECT_FALSE(MoveGivesCheck(board, NewMovement(PosStr("E3"), PosStr("E4"))));
+  EXPECT_FALSE(MoveGivesCheck(board, NewMovement(PosStr("A5"), PosStr("A4"))));
+}
+
+TEST(Board, MoveGivesCheckMatchesMakeMove) {
+  std::mt19937 rng(20250314);
+  for (int game = 0; game < 30; game++) {
+    RandomPlayout(rng, {}, [](const Board& board, const Player player,
+                              const std::vector<Movement>& moves) {
+      const GivesCheckInfo info = ComputeGivesCheckInfo(board, player);
+      for (const Movement move : moves) {
+        Board after = board;
+        Move(after, move);
+        ASSERT_EQ(MoveGivesCheck(board, info, move),
+                  IsBeingCheckmate(after, ChangePlayer(player)))
+            << BoardToString(board) << static_cast<int>(Orig(move)) << ","
+            << static_cast<int>(Dest(move));
+      }
+    });
+  }
+}
+
+TEST(Board, StaticExchangeEval) {
+  // Black soldier A3 is defended by black chariot A0.
+  const Board defended = BoardFromString(
+      "  A B C D E F G H I \n"
+      "0 r . . g * * . . . \n"
+      "1 . . . * * * . . . \n"
+      "2 . . . * * * . . . \n"
+      "3 s . . . . . . . . \n"
+      "4 - - - - - - - - - \n"
+      "5 R - - - - - - - - \n"
+      "6 . . . . . . . . . \n"
+      "7 . . . * * * . . . \n"
+      "8 . . . * * * . . . \n"
+      "9 . . . * G * . . . \n");
+  // Black soldier A3 takes a chariot moving to A4.
+  EXPECT_EQ(StaticExchangeEval(defended,
+                               NewMovement(PosStr("A5"), PosStr("A4"))),
+            -900);
+  EXPECT_EQ(StaticExchangeEval(defended,
+                               NewMovement(PosStr("A5"), PosStr("A3"))),
+            100 - 900);
+  // Quiet move next to the soldier.
+  EXPECT_EQ(StaticExchangeEval(defended,
+                               NewMovement(PosStr("A5"), PosStr("B5"))),
+            0);
+
+  // Red chariot E5 blocks red cannon E9, which only attacks E3 once the
+  // chariot moved there. Black chariot E1 defends E3.
+  const Board xray = BoardFromString(
+      "  A B C D E F G H I \n"
+      "0 . . . g * * . . . \n"
+      "1 . . . * r * . . . \n"
+      "2 . . . * * * . . . \n"
+      "3 . . . . h . . . . \n"
+      "4 - - - - - - - - - \n"
+      "5 - - - - R - - - - \n"
+      "6 . . . . . . . . . \n"
+      "7 . . . * H * . . . \n"
+      "8 . . . * * * . . . \n"
+      "9 . . . * C G . . . \n");
+  EXPECT_EQ(StaticExchangeEval(xray, NewMovement(PosStr("E5"), PosStr("E3"))),
+            400);
+  // Without the horse screen the cannon never joins.
+  Board no_screen = xray;
+  no_screen[PosStr("E7")] = PIECE_EMPTY;
+  EXPECT_EQ(
+      StaticExchangeEval(no_screen, NewMovement(PosStr("E5"), PosStr("E3"))),
+      400 - 900);
+
+  // Red horse G0 only defends E1 once black advisor F0 leaves its leg.
+  const Board leg = BoardFromString(
+      "  A B C D E F G H I \n"
+      "0 . . . g * a H . . \n"
+      "1 . . . * R * . . . \n"
+      "2 . . . * * * . . . \n"
+      "3 . . . . . . . . . \n"
+      "4 - - - - - - - - - \n"
+      "5 - - - - - - - - - \n"
+      "6 . . . . . . . . . \n"
+      "7 . . . * * * . . . \n"
+      "8 . . . * * * . . . \n"
+      "9 . . . * * G . . . \n");
+  EXPECT_EQ(StaticExchangeEval(leg, NewMovement(PosStr("F0"), PosStr("E1"))),
+            900 - 200);
+  EXPECT_EQ(StaticExchangeEval(leg, NewMovement(PosStr("E1"), PosStr("D0"))),
+            K_PIECE_VALUES[R_GENERAL]);
+}
+
+TEST(Board, StaticExchangeEvalBounds) {
+  std::mt19937 rng(20250315);
+  for (int game = 0; game < 20; game++) {
+    RandomPlayout(rng, {}, [](const Board& board, const Player player,
+                              const std::vector<Movement>& moves) {
+      for (const Movement move : moves) {
+        const Piece captured = board[Dest(move)];
+        const int32_t value =
+            K_PIECE_VALUES[captured > 0 ? captured : -captured];
+        const int32_t see = StaticExchangeEval(board, move);
+        ASSERT_LE(see, value) << BoardToString(board);
+        Board after = board;
+        Move(after, move);
+        if (!IsSquareAttacked(after, Dest(move), ChangePlayer(player))) {
+          ASSERT_EQ(see, value) << BoardToString(board);
+        }
+      }
+    });
+  }
+}
+
 TEST(Board, GetWinner) {
   const Board board_1 = BoardFromString(
       "  A B C D E F G H I \n"
@@ -1385,6 +1841,59 @@ TEST(Board, GetWinner) {
 
 TEST(Board, EncodeBoardState) {
   EXPECT_EQ(DecodeBoardState(EncodeBoardState(kStartingBoard)), kStartingBoard);
+  EXPECT_EQ(EncodeBoardState(kStartingBoard),
+            (BoardState{0x5554565357525851, 0x59404636383A3C3E,
+                        0x0403050206010700, 0x0813191B1D1F2123}));
+
+  const Board board = BoardFromString(
+      "  A B C D E F G H I \n"
+      "0 . . . a g * . . . \n"
+      "1 . . . * * * . . . \n"
+      "2 . . . * * * . . . \n"
+      "3 s . . . . . . . . \n"
+      "4 - - - - - r - - - \n"
+      "5 - - - - - - S - - \n"
+      "6 . . . . . . . . . \n"
+      "7 . . . * * * . . . \n"
+      "8 . . . * A * . . . \n"
+      "9 . . . * G * . . R \n");
+  EXPECT_EQ(EncodeBoardState(board),
+            (BoardState{0x554CFFFFFFFFFF59, 0xFFFFFF33FFFFFFFF,
+                        0x0403FFFFFFFFFF29, 0xFFFFFF1BFFFFFFFF}));
+  EXPECT_EQ(DecodeBoardState(EncodeBoardState(board)), board);
+}
+
+TEST(Board, BoardStateMove) {
+  std::mt19937 rng(20250322);
+  for (int game = 0; game < 20; game++) {
+    Board board = kStartingBoard;
+    BoardState state = EncodeBoardState(board);
+    std::vector<Movement> moves_made;
+    std::vector<Piece> captures;
+    RandomPlayout(rng, {}, Ignore{}, [&](const Board&, Player,
+                                         const Movement move) {
+      const Piece piece = board[Orig(move)];
+      const Piece captured = Move(board, move);
+      BoardStateMove(state, piece, captured, move);
+      ASSERT_EQ(state, EncodeBoardState(board)) << BoardToString(board);
+      ASSERT_EQ(DecodeBoardState(state), board) << BoardToString(board);
+      moves_made.push_back(move);
+      captures.push_back(captured);
+    });
+    ASSERT_FALSE(HasFatalFailure());
+    while (!moves_made.empty()) {
+      const Movement move = moves_made.back();
+      const Piece captured = captures.back();
+      moves_made.pop_back();
+      captures.pop_back();
+      const Piece piece = board[Dest(move)];
+      board[Orig(move)] = piece;
+      board[Dest(move)] = captured;
+      BoardStateUnmove(state, piece, captured, move);
+      ASSERT_EQ(state, EncodeBoardState(board)) << BoardToString(board);
+    }
+    ASSERT_EQ(board, kStartingBoard);
+  }
 }
 
 }  // namespace
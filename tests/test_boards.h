@@ -0,0 +1,28 @@
+// file: test_boards.h
+
+#ifndef XIANGQI_GAME_ENGINE_TESTS_TEST_BOARDS_H_
+#define XIANGQI_GAME_ENGINE_TESTS_TEST_BOARDS_H_
+
+#include "xiangqi/board.h"
+#include "xiangqi/types.h"
+
+namespace xq::test {
+
+// Both sides have lost a few pieces, with soldiers and horses across the
+// river.
+inline const Board kMidgameBoard = BoardFromString(
+    "  A B C D E F G H I \n"
+    "0 r . e a g a e . . \n"
+    "1 . . . * * * . . r \n"
+    "2 . c h * * * . c . \n"
+    "3 s . s . s . . . s \n"
+    "4 - - - - - - s - - \n"
+    "5 - - S - - - - - - \n"
+    "6 S . . . S . S h S \n"
+    "7 . C H * * * . C . \n"
+    "8 . . . * * * . . . \n"
+    "9 R . E A G A E H R \n");
+
+}  // namespace xq::test
+
+#endif  // XIANGQI_GAME_ENGINE_TESTS_TEST_BOARDS_H_
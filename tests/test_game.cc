@@ -2,8 +2,10 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
+#include <random>
 #include <type_traits>
 #include <unordered_map>
 #include <vector>
@@ -11,12 +13,14 @@
 #include "xiangqi/board.h"
 #include "xiangqi/game.h"
 #include "xiangqi/types.h"
+#include "test_util.h"
 
 namespace {
 
 namespace {
 
 using namespace ::xq;
+using namespace ::xq::test;
 
 }  // namespace
 
@@ -26,4 +30,318 @@ TEST(Game, InitialState) {
   EXPECT_EQ(game.PieceAt(Pos(0, 4)), B_GENERAL);
 }
 
+TEST(Game, Key) {
+  Game game;
+  EXPECT_EQ(game.Key(), ZobristKey(kStartingBoard, PLAYER_RED));
+  EXPECT_NE(game.Key(), ZobristKey(kStartingBoard, PLAYER_BLACK));
+
+  std::mt19937 rng(20250320);
+  RandomPlayout(rng, {.max_plies = 100, .avoid_checkmate = true}, Ignore{},
+                [&](const Board&, Player, const Movement move) {
+                  game.Move(move);
+                  ASSERT_EQ(game.Key(), ZobristKey(game.CurrentBoard(),
+                                                   game.CurrentPlayer()));
+                });
+  ASSERT_FALSE(HasFatalFailure());
+  while (game.CanUndo()) {
+    game.Undo();
+    ASSERT_EQ(game.Key(),
+              ZobristKey(game.CurrentBoard(), game.CurrentPlayer()));
+  }
+}
+
+TEST(Game, CurrentBoardState) {
+  Game game;
+  EXPECT_EQ(game.CurrentBoardState(), EncodeBoardState(kStartingBoard));
+
+  std::mt19937 rng(20250321);
+  RandomPlayout(rng, {.max_plies = 100, .avoid_checkmate = true}, Ignore{},
+                [&](const Board&, Player, const Movement move) {
+                  game.Move(move);
+                  ASSERT_EQ(game.CurrentBoardState(),
+                            EncodeBoardState(game.CurrentBoard()));
+                });
+  ASSERT_FALSE(HasFatalFailure());
+  while (game.CanUndo()) {
+    game.Undo();
+    ASSERT_EQ(game.CurrentBoardState(), EncodeBoardState(game.CurrentBoard()));
+  }
+}
+
+TEST(Game, MirrorKey) {
+  Game game;
+  EXPECT_EQ(game.MirrorKey(), game.Key());
+  EXPECT_FALSE(game.CanonicalZobristKey().mirrored);
+
+  std::mt19937 rng(20250323);
+  RandomPlayout(rng, {.max_plies = 100, .avoid_checkmate = true}, Ignore{},
+                [&](const Board&, Player, const Movement move) {
+                  game.Move(move);
+                  ASSERT_EQ(game.MirrorKey(),
+                            ZobristKey(MirrorBoardHorizontal(
+                                           game.CurrentBoard()),
+                                       game.CurrentPlayer()));
+                });
+  ASSERT_FALSE(HasFatalFailure());
+  while (game.CanUndo()) {
+    game.Undo();
+    ASSERT_EQ(game.MirrorKey(), ZobristMirrorKey(game.CurrentBoard(),
+                                                 game.CurrentPlayer()));
+  }
+}
+
+TEST(Game, CanonicalKeyOfMirroredGames) {
+  Game game_1;
+  game_1.Move(NewMovement(PosStr("B7"), PosStr("E7")));
+  game_1.Move(NewMovement(PosStr("B0"), PosStr("C2")));
+
+  // The same opening played on the other side of the board.
+  Game game_2;
+  game_2.Move(NewMovement(PosStr("H7"), PosStr("E7")));
+  game_2.Move(NewMovement(PosStr("H0"), PosStr("G2")));
+
+  EXPECT_NE(game_1.Key(), game_2.Key());
+  EXPECT_EQ(game_1.Key(), game_2.MirrorKey());
+  const CanonicalKey key_1 = game_1.CanonicalZobristKey();
+  const CanonicalKey key_2 = game_2.CanonicalZobristKey();
+  EXPECT_EQ(key_1.key, key_2.key);
+  EXPECT_NE(key_1.mirrored, key_2.mirrored);
+}
+
+TEST(Game, RepetitionCount) {
+  const std::vector<Movement> shuffle = {
+      NewMovement(PosStr("B9"), PosStr("C7")),
+      NewMovement(PosStr("B0"), PosStr("C2")),
+      NewMovement(PosStr("C7"), PosStr("B9")),
+      NewMovement(PosStr("C2"), PosStr("B0"))};
+  Game game;
+  EXPECT_EQ(game.RepetitionCount(), 0);
+  EXPECT_FALSE(game.IsRepetition());
+  for (const Movement move : shuffle) {
+    game.Move(move);
+  }
+  EXPECT_EQ(game.RepetitionCount(), 1);
+  EXPECT_TRUE(game.IsRepetition());
+  for (const Movement move : shuffle) {
+    game.Move(move);
+  }
+  EXPECT_EQ(game.RepetitionCount(), 2);
+  game.Undo();
+  EXPECT_EQ(game.RepetitionCount(), 1);
+  game.Move(shuffle.back());
+  EXPECT_EQ(game.RepetitionCount(), 2);
+
+  // A soldier move cannot be taken back, the shuffle starts over.
+  game.Move(NewMovement(PosStr("A6"), PosStr("A5")));
+  game.Move(NewMovement(PosStr("A3"), PosStr("A4")));
+  EXPECT_EQ(game.RepetitionCount(), 0);
+  for (const Movement move : shuffle) {
+    game.Move(move);
+  }
+  EXPECT_EQ(game.RepetitionCount(), 1);
+  game.Undo();
+  game.Undo();
+  game.Undo();
+  game.Undo();
+  game.Undo();
+  EXPECT_EQ(game.RepetitionCount(), 0);
+}
+
+TEST(Game, RepetitionCountMatchesHistory) {
+  // Generals and advisors shuffle between few positions, soldier moves and
+  // captures cut the history.
+  Game game;
+  game.RestoreBoard(EncodeBoardState(BoardFromString(
+      "  A B C D E F G H I \n"
+      "0 . . . g * a . . . \n"
+      "1 . . . * a * . . . \n"
+      "2 . . . * * * . . . \n"
+      "3 s . . . . . . . s \n"
+      "4 - - - - - - - - - \n"
+      "5 - - - - - - - - - \n"
+      "6 S . . . . . . . S \n"
+      "7 . . . * * * . . . \n"
+      "8 . . . * A * . . . \n"
+      "9 . . . A * G . . . \n")));
+  std::mt19937 rng(20250325);
+  std::vector<uint64_t> keys = {game.Key()};
+  size_t repetitions = 0;
+  RandomPlayout(
+      rng,
+      {.board = game.CurrentBoard(), .max_plies = 300, .avoid_checkmate = true},
+      Ignore{}, [&](const Board&, Player, const Movement move) {
+        game.Move(move);
+        keys.push_back(game.Key());
+        const size_t expected =
+            std::count(keys.begin(), keys.end() - 1, keys.back());
+        ASSERT_EQ(game.RepetitionCount(), expected) << keys.size();
+        ASSERT_EQ(game.IsRepetition(), expected > 0);
+        repetitions += expected > 0;
+      });
+  EXPECT_GT(repetitions, 0);
+}
+
+TEST(Game, SeekToPly) {
+  Game game;
+  std::mt19937 rng(20250326);
+  std::vector<Board> boards = {game.CurrentBoard()};
+  std::vector<uint64_t> keys = {game.Key()};
+  std::vector<size_t> repetitions = {0};
+  RandomPlayout(rng, {.max_plies = 300, .avoid_checkmate = true}, Ignore{},
+                [&](const Board&, Player, const Movement move) {
+                  game.Move(move);
+                  boards.push_back(game.CurrentBoard());
+                  keys.push_back(game.Key());
+                  repetitions.push_back(game.RepetitionCount());
+                });
+  const size_t num_plies = game.MovesCount();
+  const std::vector<Movement> moves = game.ExportMoves();
+  EXPECT_FALSE(game.SeekToPly(num_plies + 1));
+  EXPECT_EQ(game.MovesCount(), num_plies);
+
+  std::uniform_int_distribution<size_t> dist(0, num_plies);
+  for (int i = 0; i < 200; i++) {
+    const size_t ply = i == 0 ? 0 : dist(rng);
+    ASSERT_TRUE(game.SeekToPly(ply));
+    ASSERT_EQ(game.MovesCount(), ply);
+    ASSERT_EQ(game.RecordedMovesCount(), num_plies);
+    ASSERT_EQ(game.CurrentBoard(), boards[ply]) << ply;
+    ASSERT_EQ(game.CurrentPlayer(), ply % 2 == 0 ? PLAYER_RED : PLAYER_BLACK);
+    ASSERT_EQ(game.Key(), keys[ply]);
+    ASSERT_EQ(game.MirrorKey(),
+              ZobristMirrorKey(game.CurrentBoard(), game.CurrentPlayer()));
+    ASSERT_EQ(game.CurrentBoardState(), EncodeBoardState(boards[ply]));
+    ASSERT_EQ(game.RepetitionCount(), repetitions[ply]);
+    ASSERT_EQ(game.ExportMoves(),
+              std::vector<Movement>(moves.begin(), moves.begin() + ply));
+  }
+
+  // Undo keeps the record, replaying it does not drop anything.
+  ASSERT_TRUE(game.SeekToPly(num_plies / 2));
+  game.Undo();
+  game.Move(moves[num_plies / 2 - 1]);
+  game.Move(moves[num_plies / 2]);
+  EXPECT_EQ(game.CurrentBoard(), boards[num_plies / 2 + 1]);
+  EXPECT_EQ(game.RecordedMovesCount(), num_plies);
+  ASSERT_TRUE(game.SeekToPly(num_plies));
+  EXPECT_EQ(game.CurrentBoard(), boards[num_plies]);
+}
+
+TEST(Game, UndoMatchesSeekToPly) {
+  Game game;
+  Game sought;
+  std::mt19937 rng(20250331);
+  RandomPlayout(rng, {.max_plies = 100, .avoid_checkmate = true}, Ignore{},
+                [&](const Board&, Player, const Movement move) {
+                  game.Move(move);
+                  sought.Move(move);
+                });
+  while (game.CanUndo()) {
+    game.Undo();
+    ASSERT_TRUE(sought.SeekToPly(sought.MovesCount() - 1));
+    ASSERT_EQ(game.MovesCount(), sought.MovesCount());
+    ASSERT_EQ(game.CurrentBoard(), sought.CurrentBoard());
+    ASSERT_EQ(game.CurrentPlayer(), sought.CurrentPlayer());
+    ASSERT_EQ(game.Key(), sought.Key());
+    ASSERT_EQ(game.MirrorKey(), sought.MirrorKey());
+    ASSERT_EQ(game.CurrentBoardState(), sought.CurrentBoardState());
+    ASSERT_EQ(game.RepetitionCount(), sought.RepetitionCount());
+  }
+}
+
+TEST(Game, MoveAfterSeekToPly) {
+  Game game;
+  game.Move(NewMovement(PosStr("B7"), PosStr("E7")));
+  game.Move(NewMovement(PosStr("H0"), PosStr("G2")));
+  game.Move(NewMovement(PosStr("B9"), PosStr("C7")));
+  game.Move(NewMovement(PosStr("B0"), PosStr("C2")));
+  ASSERT_TRUE(game.SeekToPly(2));
+
+  // A different move replaces the rest of the record.
+  game.Move(NewMovement(PosStr("H9"), PosStr("G7")));
+  EXPECT_EQ(game.MovesCount(), 3);
+  EXPECT_EQ(game.RecordedMovesCount(), 3);
+  EXPECT_FALSE(game.SeekToPly(4));
+  EXPECT_EQ(game.Key(), ZobristKey(game.CurrentBoard(), game.CurrentPlayer()));
+  EXPECT_EQ(game.CurrentBoardState(), EncodeBoardState(game.CurrentBoard()));
+
+  Game replayed;
+  replayed.RestoreMoves(game.ExportMoves());
+  EXPECT_EQ(replayed.CurrentBoard(), game.CurrentBoard());
+  EXPECT_EQ(replayed.CurrentPlayer(), game.CurrentPlayer());
+  EXPECT_EQ(replayed.Key(), game.Key());
+}
+
+TEST(Game, UndoIgnoredMove) {
+  Game game;
+  game.Move(NewMovement(PosStr("H7"), PosStr("E7")));
+  const Board board = game.CurrentBoard();
+  const uint64_t key = game.Key();
+  // E5 is empty, the move is recorded but does not change the board.
+  game.Move(NewMovement(PosStr("E5"), PosStr("E0")));
+  EXPECT_EQ(game.CurrentBoard(), board);
+  EXPECT_EQ(game.MovesCount(), 2);
+
+  EXPECT_EQ(game.Undo(), NewMovement(PosStr("E5"), PosStr("E0")));
+  EXPECT_EQ(game.CurrentBoard(), board);
+  EXPECT_EQ(game.PieceAt(PosStr("E0")), B_GENERAL);
+  EXPECT_EQ(game.CurrentPlayer(), PLAYER_BLACK);
+  EXPECT_EQ(game.Key(), key);
+  EXPECT_EQ(game.MirrorKey(),
+            ZobristMirrorKey(game.CurrentBoard(), game.CurrentPlayer()));
+  EXPECT_EQ(game.CurrentBoardState(), EncodeBoardState(board));
+}
+
+TEST(Game, RestoreMovesKeepsSharedPrefix) {
+  Game game;
+  std::mt19937 rng(20250327);
+  RandomPlayout(rng, {.max_plies = 100, .avoid_checkmate = true}, Ignore{},
+                [&](const Board&, Player, const Movement move) {
+                  game.Move(move);
+                });
+  const std::vector<Movement> moves = game.ExportMoves();
+  const Board board = game.CurrentBoard();
+  const uint64_t key = game.Key();
+
+  // A branch off the middle of the game, then back to the full game.
+  std::vector<Movement> branch(moves.begin(), moves.begin() + 40);
+  Board branch_board = kStartingBoard;
+  for (const Movement move : branch) {
+    Move(branch_board, move);
+  }
+  const Player branch_player = PLAYER_RED;
+  const std::vector<Movement> branch_moves =
+      PossibleMoves(branch_board, branch_player, true);
+  ASSERT_FALSE(branch_moves.empty());
+  branch.push_back(branch_moves.back());
+  game.RestoreMoves(branch);
+  EXPECT_EQ(game.ExportMoves(), branch);
+  EXPECT_EQ(game.RecordedMovesCount(), branch.size());
+  EXPECT_EQ(game.Key(), ZobristKey(game.CurrentBoard(), game.CurrentPlayer()));
+
+  game.RestoreMoves(moves);
+  EXPECT_EQ(game.ExportMoves(), moves);
+  EXPECT_EQ(game.CurrentBoard(), board);
+  EXPECT_EQ(game.Key(), key);
+  EXPECT_EQ(game.CurrentBoardState(), EncodeBoardState(board));
+}
+
+TEST(Game, KeyTransposition) {
+  Game game_1;
+  game_1.Move(NewMovement(PosStr("B7"), PosStr("E7")));
+  game_1.Move(NewMovement(PosStr("H0"), PosStr("G2")));
+  game_1.Move(NewMovement(PosStr("B9"), PosStr("C7")));
+
+  Game game_2;
+  game_2.Move(NewMovement(PosStr("B9"), PosStr("C7")));
+  game_2.Move(NewMovement(PosStr("H0"), PosStr("G2")));
+  game_2.Move(NewMovement(PosStr("B7"), PosStr("E7")));
+
+  EXPECT_EQ(game_1.CurrentBoard(), game_2.CurrentBoard());
+  EXPECT_EQ(game_1.Key(), game_2.Key());
+
+  game_2.Undo();
+  EXPECT_NE(game_1.Key(), game_2.Key());
+}
+
 }  // namespace
@@ -0,0 +1,77 @@
+// file: test_perft.cc
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "xiangqi/board.h"
+#include "xiangqi/perft.h"
+#include "xiangqi/tracked_board.h"
+#include "xiangqi/types.h"
+#include "test_boards.h"
+
+namespace {
+
+namespace {
+
+using namespace ::xq;
+using namespace ::xq::test;
+
+}  // namespace
+
+TEST(Perft, StartingBoard) {
+  EXPECT_EQ(Perft(kStartingBoard, PLAYER_RED, 0), 1);
+  EXPECT_EQ(Perft(kStartingBoard, PLAYER_RED, 1), 44);
+  EXPECT_EQ(Perft(kStartingBoard, PLAYER_RED, 2), 1920);
+  EXPECT_EQ(Perft(kStartingBoard, PLAYER_RED, 3), 79666);
+  EXPECT_EQ(ParallelPerft(kStartingBoard, PLAYER_RED, 4), 3290240);
+}
+
+TEST(Perft, DivideAddsUp) {
+  for (const uint8_t depth : {1, 2, 3}) {
+    uint64_t total = 0;
+    const auto division = PerftDivide(kMidgameBoard, PLAYER_RED, depth);
+    EXPECT_EQ(division.size(), Perft(kMidgameBoard, PLAYER_RED, 1));
+    for (const auto& [movement, count] : division) {
+      Board board = kMidgameBoard;
+      Move(board, movement);
+      EXPECT_EQ(count, Perft(board, PLAYER_BLACK, depth - 1));
+      total += count;
+    }
+    EXPECT_EQ(total, Perft(kMidgameBoard, PLAYER_RED, depth));
+  }
+}
+
+TEST(Perft, Symmetry) {
+  for (const uint8_t depth : {1, 2, 3}) {
+    const uint64_t expected = Perft(kMidgameBoard, PLAYER_RED, depth);
+    EXPECT_EQ(Perft(FlipBoard(kMidgameBoard), PLAYER_BLACK, depth), expected);
+    EXPECT_EQ(Perft(MirrorBoardHorizontal(kMidgameBoard), PLAYER_RED, depth),
+              expected);
+  }
+}
+
+TEST(Perft, TrackedMatchesMailbox) {
+  for (const Player player : {PLAYER_RED, PLAYER_BLACK}) {
+    for (const uint8_t depth : {0, 1, 2, 3}) {
+      EXPECT_EQ(TrackedPerft(TrackBoard(kMidgameBoard), player, depth),
+                Perft(kMidgameBoard, player, depth));
+    }
+  }
+}
+
+TEST(Perft, ParallelMatchesSingleThreaded) {
+  for (const Player player : {PLAYER_RED, PLAYER_BLACK}) {
+    for (const uint8_t depth : {0, 1, 2, 3}) {
+      const uint64_t expected = Perft(kMidgameBoard, player, depth);
+      EXPECT_EQ(ParallelPerft(kMidgameBoard, player, depth, 4, 4), expected);
+      // Without the cache, and with a cache small enough to be overwritten.
+      EXPECT_EQ(ParallelPerft(kMidgameBoard, player, depth, 3, 0), expected);
+      EXPECT_EQ(ParallelPerft(kMidgameBoard, player, depth, 2, 1), expected);
+    }
+  }
+  EXPECT_EQ(ParallelPerftDivide(kStartingBoard, PLAYER_RED, 3, 4, 4),
+            PerftDivide(kStartingBoard, PLAYER_RED, 3));
+}
+
+}  // namespace
@@ -4,12 +4,14 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <random>
 #include <string_view>
 #include <vector>
 
 #include "xiangqi/board.h"
 #include "xiangqi/game.h"
 #include "xiangqi/types.h"
+#include "test_util.h"
 
 using namespace xq;
 
@@ -18,6 +20,7 @@ namespace {
 namespace {
 
 using namespace ::xq;
+using namespace ::xq::test;
 
 using ::testing::IsSupersetOf;
 
@@ -61,6 +64,22 @@ std::vector<Movement> ToMoves(const std::vector<std::string_view>& moves) {
   return result;
 }
 
+// Legal moves by making every pseudo-legal move and checking the general.
+std::vector<Movement> BruteForceLegalMoves(const Board& board,
+                                           const Player player) {
+  std::vector<Movement> result;
+  for (const Movement move : PossibleMoves(board, player, false)) {
+    Board next = board;
+    const Piece captured = Move(next, move);
+    if (captured == R_GENERAL || captured == B_GENERAL ||
+        !IsBeingCheckmate(next, player)) {
+      result.emplace_back(move);
+    }
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
 }  // namespace
 
 // ---------------------------------------------------------------------
@@ -926,6 +945,23 @@ TEST(PossiblePositions, Soldier) {
       ToVec(PossiblePositions(board_2, PosStr("E6"), /*avoid_checkmate=*/true)),
       ToPos({"F6"}));
   EXPECT_TRUE(ToVec(PossiblePositions(board_2, PosStr("H6"))).empty());
+
+  // Soldiers that have not crossed the river cannot move sideways, even when
+  // blocked by their own piece.
+  const Board board_3 = BoardFromString(
+      "  A B C D E F G H I \n"
+      "0 . . . a g a . . . \n"
+      "1 . . . * * * . . . \n"
+      "2 . . . * * * . . . \n"
+      "3 . . s . . . . . . \n"
+      "4 - - h - - - - - - \n"
+      "5 - - E - - - - - - \n"
+      "6 . . S . . . . . . \n"
+      "7 . . . * * * . . . \n"
+      "8 . . . * * * . . . \n"
+      "9 . . . A G A . . . \n");
+  EXPECT_TRUE(ToVec(PossiblePositions(board_3, PosStr("C6"))).empty());
+  EXPECT_TRUE(ToVec(PossiblePositions(board_3, PosStr("C3"))).empty());
 }
 
 TEST(PossibleMoves, StartingBoard) {
@@ -1036,4 +1072,295 @@ TEST(PossibleBoards, StartingBoard) {
                                             "9 R H E A G A E H R \n")}));
 }
 
+TEST(PossibleBoards, ChildBoards) {
+  for (const Player player : {PLAYER_RED, PLAYER_BLACK}) {
+    for (const bool avoid_checkmate : {false, true}) {
+      const std::vector<Movement> moves =
+          PossibleMoves(kStartingBoard, player, avoid_checkmate);
+      ChildBoards children(kStartingBoard, player, avoid_checkmate);
+      EXPECT_EQ(children.size(), moves.size());
+      size_t i = 0;
+      for (auto it = children.begin(); it != children.end(); ++it, i++) {
+        ASSERT_LT(i, moves.size());
+        EXPECT_EQ(it.movement(), moves[i]);
+        Board expected = kStartingBoard;
+        Move(expected, moves[i]);
+        EXPECT_EQ(*it, expected);
+      }
+      EXPECT_EQ(i, moves.size());
+    }
+  }
+}
+
+TEST(PossibleBoards, ChildBoardsRestoresBoard) {
+  Board board = kStartingBoard;
+  ChildBoardsC children;
+  const uint8_t num_children =
+      StartChildBoards_C(board.data(), PLAYER_RED, true, &children);
+  ASSERT_EQ(num_children, 44);
+  for (uint8_t i = 0; i < num_children; i++) {
+    ASSERT_TRUE(NextChildBoard_C(board.data(), &children));
+    EXPECT_NE(board, kStartingBoard);
+  }
+  EXPECT_FALSE(NextChildBoard_C(board.data(), &children));
+  EXPECT_EQ(board, kStartingBoard);
+  EXPECT_FALSE(NextChildBoard_C(board.data(), &children));
+  EXPECT_EQ(board, kStartingBoard);
+
+  // Stopping early.
+  StartChildBoards_C(board.data(), PLAYER_BLACK, false, &children);
+  ASSERT_TRUE(NextChildBoard_C(board.data(), &children));
+  ASSERT_TRUE(NextChildBoard_C(board.data(), &children));
+  StopChildBoards_C(board.data(), &children);
+  EXPECT_EQ(board, kStartingBoard);
+  EXPECT_FALSE(NextChildBoard_C(board.data(), &children));
+  EXPECT_EQ(board, kStartingBoard);
+}
+
+TEST(PossibleMoves, AvoidCheckmatePins) {
+  // Red chariot E7 is pinned by black chariot E2, it can only move along the
+  // E file.
+  const Board board_1 = BoardFromString(
+      "  A B C D E F G H I \n"
+      "0 . . . * g * . . . \n"
+      "1 . . . * * * . . . \n"
+      "2 . . . * r * . . . \n"
+      "3 . . . . . . . . . \n"
+      "4 - - - - - - - - - \n"
+      "5 - - - - - - - - - \n"
+      "6 . . . . . . . . . \n"
+      "7 . . . * R * . . . \n"
+      "8 . . . * * * . . . \n"
+      "9 . . . * G * . . . \n");
+  EXPECT_EQ(ToVec(PossiblePositions(board_1, PosStr("E7"), true)),
+            ToPos({"E8", "E6", "E5", "E4", "E3", "E2"}));
+  EXPECT_EQ(ToVec(PossibleMoves(board_1, PLAYER_RED, true)),
+            BruteForceLegalMoves(board_1, PLAYER_RED));
+
+  // Black cannon E2 has two screens E5 and E7, once either of them leaves
+  // the E file the other one becomes the only screen. Red horse D8 blocks the
+  // leg of black horse C8, it cannot move.
+  const Board board_2 = BoardFromString(
+      "  A B C D E F G H I \n"
+      "0 . . . g * * . . . \n"
+      "1 . . . * * * . . . \n"
+      "2 . . . * c * . . . \n"
+      "3 . . . . . . . . . \n"
+      "4 - - - - - - - - - \n"
+      "5 - - - - S - - - - \n"
+      "6 . . . . . . . . . \n"
+      "7 . . . * R * . . . \n"
+      "8 . . h H * * . . . \n"
+      "9 . . . * G * . . . \n");
+  const std::vector<Movement> red_moves_2 =
+      ToVec(PossibleMoves(board_2, PLAYER_RED, true));
+  EXPECT_EQ(red_moves_2, BruteForceLegalMoves(board_2, PLAYER_RED));
+  for (const Movement move : red_moves_2) {
+    const Position from = Orig(move);
+    EXPECT_NE(from, PosStr("D8"));
+    if (from == PosStr("E5") || from == PosStr("E7")) {
+      EXPECT_EQ(Col(Dest(move)), Col(from));
+    }
+  }
+
+  // Black cannon E0 faces red general E9 with nothing in between, moving a
+  // piece onto the E file gives it a screen. The flying general rule forbids
+  // moving the red general to D9.
+  const Board board_3 = BoardFromString(
+      "  A B C D E F G H I \n"
+      "0 . . . g c * . . . \n"
+      "1 . . . * * * . . . \n"
+      "2 . . . * * * . . . \n"
+      "3 . . . . . . . . . \n"
+      "4 - - - - - - - - - \n"
+      "5 - - - - - - - - - \n"
+      "6 . . . . . R . . . \n"
+      "7 . . . * * * . . . \n"
+      "8 . . . * * * . . . \n"
+      "9 . . . * G * . . . \n");
+  const std::vector<Movement> red_moves_3 =
+      ToVec(PossibleMoves(board_3, PLAYER_RED, true));
+  EXPECT_EQ(red_moves_3, BruteForceLegalMoves(board_3, PLAYER_RED));
+  EXPECT_EQ(std::count(red_moves_3.begin(), red_moves_3.end(),
+                       NewMovement(PosStr("F6"), PosStr("E6"))),
+            0);
+  EXPECT_EQ(std::count(red_moves_3.begin(), red_moves_3.end(),
+                       NewMovement(PosStr("E9"), PosStr("D9"))),
+            0);
+  EXPECT_EQ(std::count(red_moves_3.begin(), red_moves_3.end(),
+                       NewMovement(PosStr("E9"), PosStr("F9"))),
+            1);
+}
+
+TEST(PossibleMoves, HasAnyLegalMove) {
+  EXPECT_TRUE(HasAnyLegalMove(kStartingBoard, PLAYER_RED));
+  EXPECT_TRUE(HasAnyLegalMove(kStartingBoard, PLAYER_BLACK));
+
+  // Black is in check on the E file and every move of the general is covered.
+  const Board checkmate = BoardFromString(
+      "  A B C D E F G H I \n"
+      "0 . . . * g * . . . \n"
+      "1 . . . * * * . . . \n"
+      "2 . . . * * * . . . \n"
+      "3 . . . . . . . . . \n"
+      "4 - - - - - - - - - \n"
+      "5 - - - - R - - - - \n"
+      "6 . . . . . . . . . \n"
+      "7 . . . * * * . . . \n"
+      "8 . . . * * * . . . \n"
+      "9 . . . R G R . . . \n");
+  EXPECT_FALSE(HasAnyLegalMove(checkmate, PLAYER_BLACK));
+  EXPECT_TRUE(DidPlayerLose(checkmate, PLAYER_BLACK));
+  // Black advisor D0 can block on E1.
+  Board blocked = checkmate;
+  blocked[PosStr("D0")] = B_ADVISOR;
+  EXPECT_TRUE(HasAnyLegalMove(blocked, PLAYER_BLACK));
+  EXPECT_FALSE(DidPlayerLose(blocked, PLAYER_BLACK));
+
+  // Black is not in check, its general cannot move and its horse is pinned by
+  // the chariot on E6.
+  const Board stalemate = BoardFromString(
+      "  A B C D E F G H I \n"
+      "0 . . . * g * . . . \n"
+      "1 R . . * * * . . . \n"
+      "2 . . . * h * . . . \n"
+      "3 . . . . . . . . . \n"
+      "4 - - - - - - - - - \n"
+      "5 - - - R - - - - - \n"
+      "6 . . . . R . . . . \n"
+      "7 . . . * * * . . . \n"
+      "8 . . . * * * . . . \n"
+      "9 . . . * * G . . . \n");
+  ASSERT_FALSE(IsBeingCheckmate(stalemate, PLAYER_BLACK));
+  EXPECT_FALSE(HasAnyLegalMove(stalemate, PLAYER_BLACK));
+  EXPECT_TRUE(DidPlayerLose(stalemate, PLAYER_BLACK));
+  Board unpinned = stalemate;
+  unpinned[PosStr("E6")] = PIECE_EMPTY;
+  EXPECT_TRUE(HasAnyLegalMove(unpinned, PLAYER_BLACK));
+  EXPECT_FALSE(DidPlayerLose(unpinned, PLAYER_BLACK));
+}
+
+TEST(PossibleMoves, AvoidCheckmateMatchesBruteForce) {
+  std::mt19937 rng(20250310);
+  for (int game = 0; game < 30; game++) {
+    RandomPlayout(rng, {}, [](const Board& board, const Player player,
+                              const std::vector<Movement>&) {
+      const std::vector<Movement> expected =
+          BruteForceLegalMoves(board, player);
+      ASSERT_EQ(ToVec(PossibleMoves(board, player, true)), expected)
+          << BoardToString(board);
+      ASSERT_EQ(DidPlayerLose(board, player), expected.empty())
+          << BoardToString(board);
+      ASSERT_EQ(HasAnyLegalMove(board, player), !expected.empty())
+          << BoardToString(board);
+    });
+  }
+}
+
+TEST(PossibleMoves, Stages) {
+  // Red chariot E7 checks the black general, black chariot I7 can capture it,
+  // black horse D2 and black advisors can block.
+  const Board board = BoardFromString(
+      "  A B C D E F G H I \n"
+      "0 . . . a g a . . . \n"
+      "1 . . . * * * . . . \n"
+      "2 . . . h * * . . . \n"
+      "3 . . . . . . . . . \n"
+      "4 - - - - - - - - - \n"
+      "5 - - - - - - - - - \n"
+      "6 . . . . . . . . . \n"
+      "7 . . . * R * . . r \n"
+      "8 . . . * * * . . . \n"
+      "9 . . . G * * . . . \n");
+  EXPECT_EQ(ToVec(PossibleCaptures(board, PLAYER_BLACK, true)),
+            ToMoves({"I7,E7"}));
+  EXPECT_EQ(ToVec(PossibleQuietMoves(board, PLAYER_BLACK, true)),
+            ToMoves({"D2,E4", "D0,E1", "F0,E1"}));
+  EXPECT_EQ(ToVec(PossibleEvasions(board, PLAYER_BLACK)),
+            ToMoves({"I7,E7", "D2,E4", "D0,E1", "F0,E1"}));
+  EXPECT_EQ(ToVec(PossibleEvasions(board, PLAYER_BLACK)),
+            BruteForceLegalMoves(board, PLAYER_BLACK));
+}
+
+TEST(PossibleMoves, StagesMatchPossibleMoves) {
+  std::mt19937 rng(20250311);
+  for (int game = 0; game < 30; game++) {
+    RandomPlayout(rng, {}, [](const Board& board, const Player player,
+                              const std::vector<Movement>&) {
+      for (const bool avoid_checkmate : {false, true}) {
+        const std::vector<Movement> captures =
+            PossibleCaptures(board, player, avoid_checkmate);
+        const std::vector<Movement> quiets =
+            PossibleQuietMoves(board, player, avoid_checkmate);
+        for (const Movement move : captures) {
+          ASSERT_FALSE(IsEmpty(board[Dest(move)]));
+        }
+        for (const Movement move : quiets) {
+          ASSERT_TRUE(IsEmpty(board[Dest(move)]));
+        }
+        std::vector<Movement> all = captures;
+        all.insert(all.end(), quiets.begin(), quiets.end());
+        ASSERT_EQ(ToVec(all),
+                  ToVec(PossibleMoves(board, player, avoid_checkmate)))
+            << BoardToString(board);
+      }
+      if (IsBeingCheckmate(board, player)) {
+        ASSERT_EQ(ToVec(PossibleEvasions(board, player)),
+                  BruteForceLegalMoves(board, player))
+            << BoardToString(board);
+      }
+    });
+  }
+}
+
+TEST(PossibleMoves, BatchMatchesPossibleMoves) {
+  // Boards from a few random games, played in lockstep.
+  std::mt19937 rng(20250312);
+  std::vector<Board> boards(16, kStartingBoard);
+  std::vector<Player> players(boards.size(), PLAYER_RED);
+  MoveBatch batch;
+  std::vector<Board> children;
+  for (int ply = 0; ply < 60; ply++) {
+    for (const bool avoid_checkmate : {false, true}) {
+      BatchPossibleMoves(boards, players, avoid_checkmate, batch);
+      ASSERT_EQ(batch.offsets.size(), boards.size() + 1);
+      ASSERT_EQ(batch.offsets.front(), 0);
+      ASSERT_EQ(batch.offsets.back(), batch.moves.size());
+      BatchPossibleBoards(boards, batch, children);
+      ASSERT_EQ(children.size(), batch.moves.size());
+      for (size_t i = 0; i < boards.size(); i++) {
+        const std::vector<Movement> moves{
+            batch.moves.begin() + batch.offsets[i],
+            batch.moves.begin() + batch.offsets[i + 1]};
+        ASSERT_EQ(moves, PossibleMoves(boards[i], players[i], avoid_checkmate))
+            << BoardToString(boards[i]);
+        for (uint32_t j = batch.offsets[i]; j < batch.offsets[i + 1]; j++) {
+          Board expected = boards[i];
+          Move(expected, batch.moves[j]);
+          ASSERT_EQ(children[j], expected);
+        }
+      }
+    }
+    for (size_t i = 0; i < boards.size(); i++) {
+      const std::vector<Movement> moves{
+          batch.moves.begin() + batch.offsets[i],
+          batch.moves.begin() + batch.offsets[i + 1]};
+      if (GetWinner(boards[i]) != WINNER_NONE || moves.empty()) {
+        continue;
+      }
+      Move(boards[i], RandomMove(rng, moves));
+      players[i] = ChangePlayer(players[i]);
+    }
+  }
+
+  BatchPossibleMoves({}, {}, true, batch);
+  EXPECT_TRUE(batch.moves.empty());
+  EXPECT_EQ(batch.offsets, std::vector<uint32_t>{0});
+
+  // Every board needs a player.
+  BatchPossibleMoves(boards, {PLAYER_RED}, true, batch);
+  EXPECT_TRUE(batch.moves.empty());
+  EXPECT_EQ(batch.offsets, std::vector<uint32_t>{0});
+}
+
 }  // namespace
@@ -0,0 +1,157 @@
+// file: test_tracked_board.cc
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "xiangqi/board.h"
+#include "xiangqi/tracked_board.h"
+#include "xiangqi/types.h"
+#include "test_util.h"
+
+namespace {
+
+namespace {
+
+using namespace ::xq;
+using namespace ::xq::test;
+
+Board ToBoard(const TrackedBoard& tracked) {
+  Board board;
+  std::copy(tracked.board, tracked.board + K_BOARD_SIZE, board.begin());
+  return board;
+}
+
+// Checks that the piece lists and indices agree with the board.
+void ExpectConsistent(const TrackedBoard& tracked) {
+  const Board board = ToBoard(tracked);
+  for (const Player player : {PLAYER_RED, PLAYER_BLACK}) {
+    EXPECT_EQ(tracked.general[player], FindGeneral(board, player));
+    for (uint8_t i = 0; i < tracked.count[player]; i++) {
+      const Position pos = tracked.pieces[player][i];
+      ASSERT_LT(pos, K_BOARD_SIZE);
+      EXPECT_EQ(IsRed(board[pos]), player == PLAYER_RED);
+      EXPECT_EQ(tracked.index[pos], i);
+    }
+  }
+  for (Position pos = 0; pos < K_BOARD_SIZE; pos++) {
+    if (IsEmpty(board[pos])) {
+      EXPECT_EQ(tracked.index[pos], K_NO_PIECE_INDEX);
+    }
+  }
+  EXPECT_EQ(tracked.count[PLAYER_RED] + tracked.count[PLAYER_BLACK],
+            std::count_if(board.begin(), board.end(),
+                          [](const Piece piece) { return !IsEmpty(piece); }));
+}
+
+}  // namespace
+
+TEST(TrackedBoard, StartingBoard) {
+  const TrackedBoard tracked = TrackBoard(kStartingBoard);
+  EXPECT_EQ(ToBoard(tracked), kStartingBoard);
+  EXPECT_EQ(tracked.count[PLAYER_RED], 16);
+  EXPECT_EQ(tracked.count[PLAYER_BLACK], 16);
+  EXPECT_EQ(TrackedFindGeneral_C(&tracked, PLAYER_RED), PosStr("E9"));
+  EXPECT_EQ(TrackedFindGeneral_C(&tracked, PLAYER_BLACK), PosStr("E0"));
+  ExpectConsistent(tracked);
+}
+
+TEST(TrackedBoard, Move) {
+  const Board board = BoardFromString(
+      "  A B C D E F G H I \n"
+      "0 . . . a g * . . . \n"
+      "1 . . . * * * . . . \n"
+      "2 . . . * * * . . . \n"
+      "3 . . . . . . . . . \n"
+      "4 - - - - - - - - - \n"
+      "5 - - - - - - - - - \n"
+      "6 . . . . . . . . . \n"
+      "7 . . . * * * . . . \n"
+      "8 . . . * * * . . . \n"
+      "9 . . . * G * . . R \n");
+  TrackedBoard tracked = TrackBoard(board);
+  EXPECT_EQ(tracked.count[PLAYER_RED], 2);
+  EXPECT_EQ(tracked.count[PLAYER_BLACK], 2);
+
+  EXPECT_EQ(TrackedMove(tracked, NewMovement(PosStr("I9"), PosStr("I0"))),
+            PIECE_EMPTY);
+  ExpectConsistent(tracked);
+  EXPECT_EQ(TrackedMove(tracked, NewMovement(PosStr("I0"), PosStr("D0"))),
+            B_ADVISOR);
+  EXPECT_EQ(tracked.count[PLAYER_BLACK], 1);
+  ExpectConsistent(tracked);
+  EXPECT_EQ(TrackedMove(tracked, NewMovement(PosStr("D0"), PosStr("E0"))),
+            B_GENERAL);
+  EXPECT_EQ(tracked.count[PLAYER_BLACK], 0);
+  EXPECT_EQ(TrackedFindGeneral_C(&tracked, PLAYER_BLACK), K_NO_POSITION);
+  ExpectConsistent(tracked);
+
+  // Invalid moves do not change anything.
+  EXPECT_EQ(TrackedMove(tracked, K_NO_MOVEMENT), PIECE_EMPTY);
+  EXPECT_EQ(TrackedMove(tracked, NewMovement(PosStr("A0"), PosStr("A1"))),
+            PIECE_EMPTY);
+  ExpectConsistent(tracked);
+}
+
+TEST(TrackedBoard, MakeUnmakeMove) {
+  std::mt19937 rng(20250302);
+  for (int game = 0; game < 10; game++) {
+    TrackedBoard tracked = TrackBoard(kStartingBoard);
+    RandomPlayout(
+        rng, {.max_plies = 150},
+        [&](const Board& board, Player, const std::vector<Movement>& moves) {
+          // Every move must be taken back exactly, including piece list
+          // order.
+          for (const Movement movement : moves) {
+            TrackedBoard copy = tracked;
+            MoveUndo undo;
+            Board after = board;
+            ASSERT_EQ(TrackedMakeMove(copy, movement, undo),
+                      Move(after, movement));
+            ASSERT_EQ(ToBoard(copy), after);
+            ExpectConsistent(copy);
+            TrackedUnmakeMove(copy, undo);
+            ASSERT_EQ(std::memcmp(&copy, &tracked, sizeof(TrackedBoard)), 0)
+                << BoardToString(board);
+          }
+        },
+        [&](const Board&, Player, const Movement movement) {
+          TrackedMove(tracked, movement);
+        });
+  }
+}
+
+TEST(TrackedBoard, MatchMailbox) {
+  std::mt19937 rng(20250301);
+  for (int game = 0; game < 20; game++) {
+    TrackedBoard tracked = TrackBoard(kStartingBoard);
+    RandomPlayout(
+        rng, {.max_plies = 150},
+        [&](const Board& board, const Player player,
+            const std::vector<Movement>& expected) {
+          ASSERT_EQ(Sorted(TrackedPossibleMoves(tracked, player)),
+                    Sorted(expected))
+              << BoardToString(board);
+          ASSERT_EQ(Sorted(TrackedPossibleMoves(tracked, player, true)),
+                    Sorted(PossibleMoves(board, player, true)))
+              << BoardToString(board);
+          ASSERT_EQ(TrackedIsBeingCheckmate(tracked, player),
+                    IsBeingCheckmate(board, player))
+              << BoardToString(board);
+          ASSERT_EQ(TrackedDidPlayerLose(tracked, player),
+                    DidPlayerLose(board, player))
+              << BoardToString(board);
+        },
+        [&](const Board& board, Player, const Movement movement) {
+          Board after = board;
+          ASSERT_EQ(TrackedMove(tracked, movement), Move(after, movement));
+          ASSERT_EQ(ToBoard(tracked), after);
+          ExpectConsistent(tracked);
+        });
+  }
+}
+
+}  // namespace
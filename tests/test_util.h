@@ -0,0 +1,74 @@
+// file: test_util.h
+
+#ifndef XIANGQI_GAME_ENGINE_TESTS_TEST_UTIL_H_
+#define XIANGQI_GAME_ENGINE_TESTS_TEST_UTIL_H_
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "xiangqi/board.h"
+#include "xiangqi/types.h"
+
+namespace xq::test {
+
+inline std::vector<Movement> Sorted(std::vector<Movement> moves) {
+  std::sort(moves.begin(), moves.end());
+  return moves;
+}
+
+// A uniformly random move of moves, which must not be empty.
+inline Movement RandomMove(std::mt19937& rng,
+                           const std::vector<Movement>& moves) {
+  std::uniform_int_distribution<size_t> dist(0, moves.size() - 1);
+  return moves[dist(rng)];
+}
+
+struct PlayoutOptions {
+  Board board = kStartingBoard;
+  Player player = PLAYER_RED;
+  int max_plies = 200;
+  // Moves are picked from PossibleMoves(board, player, avoid_checkmate).
+  bool avoid_checkmate = false;
+};
+
+// Callback of RandomPlayout that does nothing.
+struct Ignore {
+  template <typename... Args>
+  void operator()(const Args&...) const {}
+};
+
+// Plays a random game from options.board, until options.max_plies plies were
+// played, there is a winner or the player to move has no moves. Calls
+// visit(board, player, moves) on every position with the moves to pick from,
+// and on_move(board, player, move) with the picked move before it is made on
+// board. Stops at the first fatal failure in either of them.
+template <typename Visit, typename OnMove = Ignore>
+void RandomPlayout(std::mt19937& rng, const PlayoutOptions& options,
+                   Visit&& visit, OnMove&& on_move = {}) {
+  Board board = options.board;
+  Player player = options.player;
+  for (int ply = 0; ply < options.max_plies && GetWinner(board) == WINNER_NONE;
+       ply++) {
+    const std::vector<Movement> moves =
+        PossibleMoves(board, player, options.avoid_checkmate);
+    visit(std::as_const(board), player, moves);
+    if (::testing::Test::HasFatalFailure() || moves.empty()) {
+      return;
+    }
+    const Movement move = RandomMove(rng, moves);
+    on_move(std::as_const(board), player, move);
+    if (::testing::Test::HasFatalFailure()) {
+      return;
+    }
+    Move(board, move);
+    player = ChangePlayer(player);
+  }
+}
+
+}  // namespace xq::test
+
+#endif  // XIANGQI_GAME_ENGINE_TESTS_TEST_UTIL_H_
@@ -0,0 +1,154 @@
+// file: test_variation_tree.cc
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "xiangqi/board.h"
+#include "xiangqi/game.h"
+#include "xiangqi/types.h"
+#include "xiangqi/variation_tree.h"
+#include "test_util.h"
+
+namespace {
+
+namespace {
+
+using namespace ::xq;
+using namespace ::xq::test;
+
+}  // namespace
+
+TEST(VariationTree, InitialState) {
+  VariationTree tree;
+  EXPECT_EQ(tree.Current(), VariationTree::kRoot);
+  EXPECT_EQ(tree.CurrentBoard(), kStartingBoard);
+  EXPECT_EQ(tree.CurrentPlayer(), PLAYER_RED);
+  EXPECT_EQ(tree.Key(), ZobristKey(kStartingBoard, PLAYER_RED));
+  EXPECT_EQ(tree.NodesCount(), 1);
+  EXPECT_EQ(tree.Parent(VariationTree::kRoot), VariationTree::kNoNode);
+  EXPECT_EQ(tree.FirstChild(VariationTree::kRoot), VariationTree::kNoNode);
+  EXPECT_FALSE(tree.Back());
+}
+
+TEST(VariationTree, SharedPrefix) {
+  VariationTree tree;
+  const Movement cannon = NewMovement(PosStr("B7"), PosStr("E7"));
+  const Movement horse = NewMovement(PosStr("H0"), PosStr("G2"));
+  const Movement main_reply = NewMovement(PosStr("B9"), PosStr("C7"));
+  const Movement side_reply = NewMovement(PosStr("H9"), PosStr("G7"));
+
+  tree.Move(cannon);
+  const VariationNode fork = tree.Move(horse);
+  const VariationNode main_line = tree.Move(main_reply);
+  ASSERT_TRUE(tree.Back());
+  const VariationNode side_line = tree.Move(side_reply);
+  EXPECT_EQ(tree.NodesCount(), 5);
+  EXPECT_EQ(tree.Parent(main_line), fork);
+  EXPECT_EQ(tree.Parent(side_line), fork);
+  EXPECT_EQ(tree.Children(fork),
+            (std::vector<VariationNode>{main_line, side_line}));
+  EXPECT_EQ(tree.Line(side_line),
+            (std::vector<Movement>{cannon, horse, side_reply}));
+  EXPECT_EQ(tree.Depth(side_line), 3);
+
+  // Replaying an existing move reuses its node.
+  ASSERT_TRUE(tree.GoTo(fork));
+  EXPECT_EQ(tree.Move(main_reply), main_line);
+  EXPECT_EQ(tree.NodesCount(), 5);
+  EXPECT_EQ(tree.FindChild(fork, side_reply), side_line);
+  EXPECT_EQ(tree.FindChild(fork, cannon), VariationTree::kNoNode);
+
+  tree.PromoteVariation(side_line);
+  EXPECT_EQ(tree.FirstChild(fork), side_line);
+  EXPECT_EQ(tree.NextSibling(side_line), main_line);
+  EXPECT_EQ(tree.NextSibling(main_line), VariationTree::kNoNode);
+
+  EXPECT_FALSE(tree.GoTo(5));
+  EXPECT_EQ(tree.Current(), main_line);
+}
+
+TEST(VariationTree, BackAfterIgnoredMove) {
+  VariationTree tree;
+  // E5 is empty, the move does not change the board.
+  const VariationNode node = tree.Move(NewMovement(PosStr("E5"), PosStr("E0")));
+  EXPECT_EQ(tree.CurrentBoard(), kStartingBoard);
+  EXPECT_EQ(tree.Key(), ZobristKey(kStartingBoard, PLAYER_BLACK));
+  tree.Move(NewMovement(PosStr("B2"), PosStr("B9")));
+  ASSERT_TRUE(tree.Back());
+  ASSERT_TRUE(tree.Back());
+  EXPECT_EQ(tree.CurrentBoard(), kStartingBoard);
+  ASSERT_TRUE(tree.GoTo(node));
+  EXPECT_EQ(tree.CurrentBoard(), kStartingBoard);
+}
+
+TEST(VariationTree, GoToMatchesReplay) {
+  const Board board = BoardFromString(
+      "  A B C D E F G H I \n"
+      "0 . . . g * a . . . \n"
+      "1 . . . * a * . . . \n"
+      "2 . . . * * * . . . \n"
+      "3 s . . . . . h . s \n"
+      "4 - - - - - - - - - \n"
+      "5 - - - - - - - - - \n"
+      "6 S . . . . . . . S \n"
+      "7 . . . * * * . H . \n"
+      "8 . . . * A * . . . \n"
+      "9 . . . A * G . . . \n");
+  VariationTree tree(board, PLAYER_BLACK);
+  std::mt19937 rng(20250328);
+  std::vector<VariationNode> nodes = {VariationTree::kRoot};
+  for (int i = 0; i < 500; i++) {
+    // Either goes to a random node and branches off it, or extends the line.
+    if (i % 8 == 0) {
+      std::uniform_int_distribution<size_t> dist(0, nodes.size() - 1);
+      ASSERT_TRUE(tree.GoTo(nodes[dist(rng)]));
+    }
+    const std::vector<Movement> moves =
+        PossibleMoves(tree.CurrentBoard(), tree.CurrentPlayer(), true);
+    if (moves.empty()) {
+      continue;
+    }
+    nodes.push_back(tree.Move(RandomMove(rng, moves)));
+  }
+  // Moves played again from the same node did not add nodes.
+  EXPECT_EQ(tree.NodesCount(),
+            std::set<VariationNode>(nodes.begin(), nodes.end()).size());
+
+  std::uniform_int_distribution<size_t> dist(0, nodes.size() - 1);
+  for (int i = 0; i < 200; i++) {
+    const VariationNode node = nodes[dist(rng)];
+    ASSERT_TRUE(tree.GoTo(node));
+    ASSERT_EQ(tree.Current(), node);
+
+    Board expected = board;
+    for (const Movement move : tree.Line(node)) {
+      Move(expected, move);
+    }
+    ASSERT_EQ(tree.CurrentBoard(), expected);
+    const Player player =
+        tree.Depth(node) % 2 == 0 ? PLAYER_BLACK : PLAYER_RED;
+    ASSERT_EQ(tree.CurrentPlayer(), player);
+    ASSERT_EQ(tree.Key(), ZobristKey(expected, player));
+    ASSERT_EQ(tree.KeyOf(node), tree.Key());
+  }
+}
+
+TEST(VariationTree, LineOfGame) {
+  Game game;
+  VariationTree tree;
+  std::mt19937 rng(20250329);
+  RandomPlayout(rng, {.max_plies = 100, .avoid_checkmate = true}, Ignore{},
+                [&](const Board&, Player, const Movement move) {
+                  game.Move(move);
+                  tree.Move(move);
+                  ASSERT_EQ(tree.Key(), game.Key());
+                });
+  EXPECT_EQ(tree.Line(tree.Current()), game.ExportMoves());
+  EXPECT_EQ(tree.CurrentBoard(), game.CurrentBoard());
+}
+
+}  // namespace